@@ -124,13 +124,11 @@ class BenchmarkIlios
   end
 
   def run_execute_async(x)
-    # ilios binds values into a single mutable statement per Cassandra::Statement
-    # object, so each concurrently in-flight query needs its own statement;
-    # otherwise rebinding would race on values the driver is still reading.
-    statements = Array.new(BATCH_SIZE) { build_statement }
+    # Statement#bind_new gives each in-flight query its own values while
+    # sharing a single prepared statement.
     x.report("ilios:execute_async (batch=#{BATCH_SIZE})") do
-      futures = statements.map do |st|
-        st.bind(
+      futures = Array.new(BATCH_SIZE) do
+        st = statement.bind_new(
           {
             id: Random.rand(2**40),
             message: 'hello',
@@ -144,11 +142,7 @@ class BenchmarkIlios
   end
 
   def statement
-    @statement ||= build_statement
-  end
-
-  def build_statement
-    Ilios::Cassandra.session.prepare(<<-CQL)
+    @statement ||= Ilios::Cassandra.session.prepare(<<-CQL)
       INSERT INTO ilios.benchmark_insert (
         id,
         message,
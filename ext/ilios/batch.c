@@ -0,0 +1,224 @@
+#include "ilios.h"
+
+static void batch_mark(void *ptr);
+static void batch_destroy(void *ptr);
+static size_t batch_memsize(const void *ptr);
+static void batch_compact(void *ptr);
+
+const rb_data_type_t cassandra_batch_data_type = {
+    "Ilios::Cassandra::Batch",
+    {
+        batch_mark,
+        batch_destroy,
+        batch_memsize,
+        batch_compact,
+    },
+    0, 0,
+    RUBY_TYPED_FREE_IMMEDIATELY | RUBY_TYPED_WB_PROTECTED | RUBY_TYPED_FROZEN_SHAREABLE,
+};
+
+static VALUE batch_allocator(VALUE klass)
+{
+    CassandraBatch *cassandra_batch;
+    VALUE obj = CREATE_BATCH(cassandra_batch);
+
+    cassandra_batch->type = CASS_BATCH_TYPE_LOGGED;
+    cassandra_batch->consistency = CASS_CONSISTENCY_UNKNOWN;
+    cassandra_batch->idempotent = idempotency_unset;
+    // Set here rather than only in initialize, so that an allocated but
+    // uninitialized batch is still safe to use.
+    RB_OBJ_WRITE(obj, &cassandra_batch->statements, rb_ary_new());
+    return obj;
+}
+
+/**
+ * Creates a new batch.
+ *
+ * @param type [Integer] A batch type, one of +LOGGED+, +UNLOGGED+ or +COUNTER+. The default is +LOGGED+.
+ * @return [Cassandra::Batch] A new batch.
+ * @raise [ArgumentError] If an invalid batch type was given.
+ */
+static VALUE batch_initialize(int argc, VALUE *argv, VALUE self)
+{
+    CassandraBatch *cassandra_batch;
+    VALUE type;
+
+    rb_scan_args(argc, argv, "01", &type);
+
+    GET_BATCH(self, cassandra_batch);
+    if (!NIL_P(type)) {
+        int batch_type = NUM2INT(type);
+
+        if (batch_type != CASS_BATCH_TYPE_LOGGED &&
+            batch_type != CASS_BATCH_TYPE_UNLOGGED &&
+            batch_type != CASS_BATCH_TYPE_COUNTER) {
+            rb_raise(rb_eArgError, "Invalid batch type: %d", batch_type);
+        }
+        cassandra_batch->type = (CassBatchType)batch_type;
+    }
+    RB_OBJ_WRITE(self, &cassandra_batch->statements, rb_ary_new());
+
+    return self;
+}
+
+/**
+ * Adds a statement to the batch.
+ * The values bound to the statement at this point are used, so the statement
+ * can be re-bound afterwards without changing the batch.
+ *
+ * @param statement [Cassandra::Statement] A statement to add.
+ * @param values [Hash, Array, nil] Values to bind for this statement only.
+ * @return [Cassandra::Batch] self.
+ * @raise [TypeError] If the invalid object is given.
+ * @raise [Cassandra::StatementError] If an invalid column name was given.
+ */
+static VALUE batch_add(int argc, VALUE *argv, VALUE self)
+{
+    CassandraBatch *cassandra_batch;
+    VALUE statement, values;
+
+    rb_scan_args(argc, argv, "11", &statement, &values);
+
+    GET_BATCH(self, cassandra_batch);
+    rb_check_typeddata(statement, &cassandra_statement_data_type);
+    if (NIL_P(values)) {
+        values = rb_ary_new();
+    }
+    rb_ary_push(cassandra_batch->statements, statement_bind_new(statement, values));
+
+    return self;
+}
+
+/**
+ * Sets the batch's consistency level. The default is the cluster's.
+ *
+ * @param consistency [Integer] A consistency level such as +Cassandra::CONSISTENCY_QUORUM+.
+ * @return [Cassandra::Batch] self.
+ */
+static VALUE batch_consistency(VALUE self, VALUE consistency)
+{
+    CassandraBatch *cassandra_batch;
+
+    GET_BATCH(self, cassandra_batch);
+    cassandra_batch->consistency = (CassConsistency)NUM2INT(consistency);
+    return self;
+}
+
+/**
+ * Sets whether the batch is idempotent. Idempotent batches are able to be
+ * automatically retried after timeouts/errors and can be speculatively executed.
+ * The default is +false+.
+ *
+ * @param idempotent [Boolean] Whether the batch is idempotent.
+ * @return [Cassandra::Batch] self.
+ */
+static VALUE batch_idempotent(VALUE self, VALUE idempotent)
+{
+    CassandraBatch *cassandra_batch;
+
+    GET_BATCH(self, cassandra_batch);
+    cassandra_batch->idempotent = RTEST(idempotent) ? idempotency_true : idempotency_false;
+    return self;
+}
+
+/**
+ * Returns the number of statements in the batch.
+ *
+ * @return [Integer] The number of statements.
+ */
+static VALUE batch_size(VALUE self)
+{
+    CassandraBatch *cassandra_batch;
+
+    GET_BATCH(self, cassandra_batch);
+    return LONG2NUM(RARRAY_LEN(cassandra_batch->statements));
+}
+
+typedef struct
+{
+    CassandraBatch *cassandra_batch;
+    CassBatch *batch;
+} batch_build_args;
+
+static VALUE batch_build_body(VALUE arg)
+{
+    batch_build_args *args = (batch_build_args *)arg;
+    VALUE statements = args->cassandra_batch->statements;
+
+    for (long i = 0; i < RARRAY_LEN(statements); i++) {
+        CassandraStatement *cassandra_statement;
+        CassStatement *statement;
+
+        GET_STATEMENT(RARRAY_AREF(statements, i), cassandra_statement);
+        statement = statement_build_for_execution(cassandra_statement);
+        cass_batch_add_statement(args->batch, statement);
+        // The batch holds its own reference to the statement.
+        cass_statement_free(statement);
+    }
+    return Qnil;
+}
+
+/*
+ * Builds a fresh CassBatch carrying the current configuration and statements
+ * for a single execution, so adding statements later cannot race with the
+ * driver (see statement_build_for_execution). The caller owns the returned
+ * batch and may free it as soon as it is submitted.
+ */
+CassBatch *batch_build_for_execution(CassandraBatch *cassandra_batch)
+{
+    CassBatch *batch = cass_batch_new(cassandra_batch->type);
+    batch_build_args args = { cassandra_batch, batch };
+    int state = 0;
+
+    if (cassandra_batch->consistency != CASS_CONSISTENCY_UNKNOWN) {
+        cass_batch_set_consistency(batch, cassandra_batch->consistency);
+    }
+    if (cassandra_batch->idempotent != idempotency_unset) {
+        cass_batch_set_is_idempotent(batch, cassandra_batch->idempotent == idempotency_true ? cass_true : cass_false);
+    }
+
+    rb_protect(batch_build_body, (VALUE)&args, &state);
+    if (state) {
+        cass_batch_free(batch);
+        rb_jump_tag(state);
+    }
+    return batch;
+}
+
+static void batch_mark(void *ptr)
+{
+    CassandraBatch *cassandra_batch = (CassandraBatch *)ptr;
+    rb_gc_mark_movable(cassandra_batch->statements);
+}
+
+static void batch_destroy(void *ptr)
+{
+    CassandraBatch *cassandra_batch = (CassandraBatch *)ptr;
+    xfree(cassandra_batch);
+}
+
+static size_t batch_memsize(const void *ptr)
+{
+    return sizeof(CassandraBatch);
+}
+
+static void batch_compact(void *ptr)
+{
+    CassandraBatch *cassandra_batch = (CassandraBatch *)ptr;
+
+    cassandra_batch->statements = rb_gc_location(cassandra_batch->statements);
+}
+
+void Init_batch(void)
+{
+    rb_define_alloc_func(cBatch, batch_allocator);
+    rb_define_method(cBatch, "initialize", batch_initialize, -1);
+    rb_define_method(cBatch, "add", batch_add, -1);
+    rb_define_method(cBatch, "consistency=", batch_consistency, 1);
+    rb_define_method(cBatch, "idempotent=", batch_idempotent, 1);
+    rb_define_method(cBatch, "size", batch_size, 0);
+
+    rb_define_const(cBatch, "LOGGED", INT2NUM(CASS_BATCH_TYPE_LOGGED));
+    rb_define_const(cBatch, "UNLOGGED", INT2NUM(CASS_BATCH_TYPE_UNLOGGED));
+    rb_define_const(cBatch, "COUNTER", INT2NUM(CASS_BATCH_TYPE_COUNTER));
+}
@@ -0,0 +1,428 @@
+#include "ilios.h"
+
+#define BULK_LOAD_DEFAULT_CONCURRENCY 64
+#define BULK_LOAD_DEFAULT_BATCH_SIZE 32
+
+typedef struct bulk_load_slot
+{
+    // The request in flight, or NULL for a free slot.
+    CassFuture *future;
+    long rows;
+    struct bulk_load_signal *signal;
+    // Next slot in the completed or the free list.
+    struct bulk_load_slot *next;
+} bulk_load_slot;
+
+/*
+ * Shared between the loader and the driver's callbacks. Each in-flight request
+ * holds a reference, so a callback firing late never touches freed memory.
+ * A callback pushes its slot to the completed list and then posts the
+ * semaphore once, so that every wait reaps exactly one slot.
+ */
+typedef struct bulk_load_signal
+{
+    rb_atomic_t refcount;
+    uv_sem_t sem;
+    bulk_load_slot *completed;
+    // The window of requests in flight, one slot per concurrency.
+    bulk_load_slot slots[];
+} bulk_load_signal;
+
+typedef struct
+{
+    CassSession *session;
+    VALUE statement;
+    bulk_load_signal *signal;
+
+    // Slots not in flight, never touched by the callbacks.
+    bulk_load_slot *free_slots;
+    long concurrency;
+    long in_flight;
+
+    // Rows waiting to be grouped into batches, by partition key.
+    size_t *key_indices;
+    long key_count;
+    long batch_size;
+    VALUE groups;
+    long buffered;
+
+    long rows;
+    long succeeded;
+    long failed;
+    long requests;
+    VALUE errors;
+} bulk_load_context;
+
+static VALUE sym_rows;
+static VALUE sym_succeeded;
+static VALUE sym_failed;
+static VALUE sym_requests;
+static VALUE sym_errors;
+static VALUE sym_elapsed;
+
+static void bulk_load_signal_release(bulk_load_signal *signal)
+{
+    if (RUBY_ATOMIC_FETCH_SUB(signal->refcount, 1) == 1) {
+        uv_sem_destroy(&signal->sem);
+        free(signal);
+    }
+}
+
+static void bulk_load_completion_cb(CassFuture *future, void *data)
+{
+    bulk_load_slot *slot = (bulk_load_slot *)data;
+    bulk_load_signal *signal = slot->signal;
+    bulk_load_slot *head;
+
+    do {
+        head = signal->completed;
+        slot->next = head;
+    } while (RUBY_ATOMIC_PTR_CAS(signal->completed, head, slot) != head);
+    uv_sem_post(&signal->sem);
+    bulk_load_signal_release(signal);
+}
+
+static void bulk_load_complete(bulk_load_context *ctx, bulk_load_slot *slot)
+{
+    CassError error_code = cass_future_error_code(slot->future);
+
+    if (error_code == CASS_OK) {
+        ctx->succeeded += slot->rows;
+    } else {
+        const char *message;
+        size_t message_length;
+        VALUE key, count;
+
+        ctx->failed += slot->rows;
+        cass_future_error_message(slot->future, &message, &message_length);
+        key = rb_str_new(message, message_length);
+        count = rb_hash_lookup2(ctx->errors, key, INT2FIX(0));
+        rb_hash_aset(ctx->errors, key, LONG2NUM(NUM2LONG(count) + slot->rows));
+    }
+    cass_future_free(slot->future);
+}
+
+/*
+ * Waits for a completion signal and retires the request it was posted for.
+ */
+static void bulk_load_reap(bulk_load_context *ctx)
+{
+    bulk_load_signal *signal = ctx->signal;
+    bulk_load_slot *slot;
+
+    nogvl_sem_wait(&signal->sem);
+
+    // The only consumer, so a popped slot can't come back in between. The
+    // list is empty if the wait was interrupted instead.
+    do {
+        slot = signal->completed;
+    } while (slot && RUBY_ATOMIC_PTR_CAS(signal->completed, slot, slot->next) != slot);
+    if (slot) {
+        bulk_load_complete(ctx, slot);
+        slot->future = NULL;
+        slot->next = ctx->free_slots;
+        ctx->free_slots = slot;
+        ctx->in_flight--;
+    }
+    rb_thread_check_ints();
+}
+
+static void bulk_load_acquire_slot(bulk_load_context *ctx)
+{
+    while (ctx->in_flight >= ctx->concurrency) {
+        bulk_load_reap(ctx);
+    }
+}
+
+static void bulk_load_track(bulk_load_context *ctx, CassFuture *future, long rows)
+{
+    bulk_load_slot *slot = ctx->free_slots;
+
+    ctx->free_slots = slot->next;
+    ctx->in_flight++;
+    slot->future = future;
+    slot->rows = rows;
+    ctx->requests++;
+
+    RUBY_ATOMIC_INC(ctx->signal->refcount);
+    if (cass_future_set_callback(future, bulk_load_completion_cb, slot) != CASS_OK) {
+        // Signal right away so the request is still reaped.
+        bulk_load_completion_cb(future, slot);
+    }
+}
+
+static void bulk_load_submit_statement(bulk_load_context *ctx, VALUE bound_statement)
+{
+    CassandraStatement *cassandra_statement;
+    CassStatement *statement;
+    CassFuture *future;
+
+    GET_STATEMENT(bound_statement, cassandra_statement);
+
+    bulk_load_acquire_slot(ctx);
+    statement = statement_build_for_execution(cassandra_statement);
+    future = nogvl_session_execute(ctx->session, statement);
+    // The driver's request holds its own reference to the statement internals.
+    cass_statement_free(statement);
+    bulk_load_track(ctx, future, 1);
+}
+
+static void bulk_load_submit_group(bulk_load_context *ctx, VALUE group)
+{
+    CassandraStatement *cassandra_statement;
+    CassandraBatch cassandra_batch;
+    CassBatch *batch;
+    CassFuture *future;
+
+    GET_STATEMENT(ctx->statement, cassandra_statement);
+    cassandra_batch.type = CASS_BATCH_TYPE_UNLOGGED;
+    cassandra_batch.statements = group;
+    cassandra_batch.consistency = CASS_CONSISTENCY_UNKNOWN;
+    cassandra_batch.idempotent = cassandra_statement->idempotent;
+
+    bulk_load_acquire_slot(ctx);
+    batch = batch_build_for_execution(&cassandra_batch);
+    future = nogvl_session_execute_batch(ctx->session, batch);
+    cass_batch_free(batch);
+    bulk_load_track(ctx, future, RARRAY_LEN(group));
+}
+
+static int bulk_load_collect_group(VALUE key, VALUE group, VALUE groups)
+{
+    rb_ary_push(groups, group);
+    return ST_CONTINUE;
+}
+
+static void bulk_load_flush_groups(bulk_load_context *ctx)
+{
+    VALUE groups = rb_ary_new_capa(RHASH_SIZE(ctx->groups));
+
+    rb_hash_foreach(ctx->groups, bulk_load_collect_group, groups);
+
+    rb_hash_clear(ctx->groups);
+    ctx->buffered = 0;
+    for (long i = 0; i < RARRAY_LEN(groups); i++) {
+        bulk_load_submit_group(ctx, RARRAY_AREF(groups, i));
+    }
+}
+
+static void bulk_load_group(bulk_load_context *ctx, VALUE bound_statement)
+{
+    VALUE key = rb_str_buf_new(0);
+    VALUE group;
+
+    for (long i = 0; i < ctx->key_count; i++) {
+        statement_append_value_key(bound_statement, ctx->key_indices[i], key);
+    }
+
+    group = rb_hash_lookup(ctx->groups, key);
+    if (NIL_P(group)) {
+        group = rb_ary_new_capa(ctx->batch_size);
+        rb_hash_aset(ctx->groups, key, group);
+    }
+    rb_ary_push(group, bound_statement);
+    ctx->buffered++;
+
+    if (RARRAY_LEN(group) >= ctx->batch_size) {
+        rb_hash_delete(ctx->groups, key);
+        ctx->buffered -= RARRAY_LEN(group);
+        bulk_load_submit_group(ctx, group);
+    } else if (ctx->buffered >= ctx->batch_size * ctx->concurrency) {
+        // Too many partitions with few rows each: send what we have rather
+        // than buffering the whole input.
+        bulk_load_flush_groups(ctx);
+    }
+}
+
+static VALUE bulk_load_row_i(RB_BLOCK_CALL_FUNC_ARGLIST(row, arg))
+{
+    bulk_load_context *ctx = (bulk_load_context *)arg;
+    VALUE bound_statement = statement_bind_new(ctx->statement, row);
+
+    ctx->rows++;
+    if (ctx->key_count > 0) {
+        bulk_load_group(ctx, bound_statement);
+    } else {
+        bulk_load_submit_statement(ctx, bound_statement);
+    }
+    return Qnil;
+}
+
+typedef struct
+{
+    bulk_load_context *ctx;
+    VALUE enumerable;
+} bulk_load_args;
+
+static VALUE bulk_load_body(VALUE arg)
+{
+    bulk_load_args *args = (bulk_load_args *)arg;
+    bulk_load_context *ctx = args->ctx;
+
+    rb_block_call(args->enumerable, id_each, 0, NULL, bulk_load_row_i, (VALUE)ctx);
+    if (ctx->key_count > 0) {
+        bulk_load_flush_groups(ctx);
+    }
+    while (ctx->in_flight > 0) {
+        bulk_load_reap(ctx);
+    }
+    return Qnil;
+}
+
+static VALUE bulk_load_ensure(VALUE arg)
+{
+    bulk_load_context *ctx = (bulk_load_context *)arg;
+
+    // Only reached with requests in flight if the body raised.
+    for (long i = 0; i < ctx->concurrency; i++) {
+        bulk_load_slot *slot = &ctx->signal->slots[i];
+
+        if (slot->future) {
+            nogvl_future_wait(slot->future);
+            cass_future_free(slot->future);
+            slot->future = NULL;
+        }
+    }
+    ctx->in_flight = 0;
+
+    bulk_load_signal_release(ctx->signal);
+    xfree(ctx->key_indices);
+    return Qnil;
+}
+
+static void bulk_load_resolve_keys(bulk_load_context *ctx, VALUE batch_by_partition)
+{
+    VALUE names;
+
+    if (!RTEST(batch_by_partition)) {
+        return;
+    }
+    names = RB_TYPE_P(batch_by_partition, T_ARRAY) ? batch_by_partition : rb_ary_new_from_args(1, batch_by_partition);
+    if (RARRAY_LEN(names) == 0) {
+        return;
+    }
+
+    ctx->key_indices = ALLOC_N(size_t, RARRAY_LEN(names));
+    for (long i = 0; i < RARRAY_LEN(names); i++) {
+        ctx->key_indices[i] = statement_parameter_index(ctx->statement, RARRAY_AREF(names, i));
+        ctx->key_count++;
+    }
+}
+
+static double bulk_load_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/**
+ * Executes a given statement once for each row of an enumerable, keeping a
+ * fixed number of requests in flight. Rows are read as they are needed, so
+ * memory use stays bounded however large the input is.
+ * Failed requests don't stop the load; they are counted in the returned
+ * summary.
+ *
+ * @param statement [Cassandra::Statement] A statement to execute.
+ * @param enumerable [Enumerable<Hash, Array>] Values to bind for each row.
+ * @param concurrency [Integer] The number of requests kept in flight. The default is +64+.
+ * @param batch_by_partition [Symbol, String, Array<Symbol, String>, nil] Names of the
+ *   statement's partition key parameters. If given, rows with the same partition key
+ *   are sent together in unlogged batches.
+ * @param batch_size [Integer] The maximum number of rows in a batch. The default is +32+.
+ * @return [Hash] The number of +:rows+ read, rows +:succeeded+ and +:failed+,
+ *   +:requests+ sent, +:errors+ as a hash of error messages to row counts,
+ *   and +:elapsed+ seconds.
+ * @raise [ArgumentError] If concurrency or batch_size is not positive.
+ * @raise [TypeError] If the invalid object is given.
+ * @raise [Cassandra::StatementError] If an invalid column name was given.
+ */
+static VALUE session_bulk_load(int argc, VALUE *argv, VALUE self)
+{
+    static ID keywords[3];
+    CassandraSession *cassandra_session;
+    bulk_load_context ctx = { 0 };
+    bulk_load_args args;
+    VALUE statement, enumerable, options;
+    VALUE values[3] = { Qundef, Qundef, Qundef };
+    VALUE summary;
+    double started_at;
+
+    rb_scan_args(argc, argv, "2:", &statement, &enumerable, &options);
+    if (!keywords[0]) {
+        keywords[0] = rb_intern("concurrency");
+        keywords[1] = rb_intern("batch_by_partition");
+        keywords[2] = rb_intern("batch_size");
+    }
+    if (!NIL_P(options)) {
+        rb_get_kwargs(options, keywords, 0, 3, values);
+    }
+
+    GET_SESSION(self, cassandra_session);
+    rb_check_typeddata(statement, &cassandra_statement_data_type);
+
+    ctx.session = cassandra_session->session;
+    ctx.statement = statement;
+    ctx.concurrency = values[0] == Qundef ? BULK_LOAD_DEFAULT_CONCURRENCY : NUM2LONG(values[0]);
+    ctx.batch_size = values[2] == Qundef ? BULK_LOAD_DEFAULT_BATCH_SIZE : NUM2LONG(values[2]);
+    if (ctx.concurrency <= 0) {
+        rb_raise(rb_eArgError, "concurrency must be positive: %ld", ctx.concurrency);
+    }
+    if (ctx.batch_size <= 0) {
+        rb_raise(rb_eArgError, "batch_size must be positive: %ld", ctx.batch_size);
+    }
+    ctx.groups = rb_hash_new();
+    ctx.errors = rb_hash_new();
+
+    bulk_load_resolve_keys(&ctx, values[1] == Qundef ? Qnil : values[1]);
+    if ((unsigned long)ctx.concurrency > (SIZE_MAX - sizeof(bulk_load_signal)) / sizeof(bulk_load_slot)) {
+        xfree(ctx.key_indices);
+        rb_raise(rb_eArgError, "concurrency is too large: %ld", ctx.concurrency);
+    }
+    ctx.signal = (bulk_load_signal *)malloc(sizeof(bulk_load_signal) + sizeof(bulk_load_slot) * (size_t)ctx.concurrency);
+    if (ctx.signal == NULL) {
+        xfree(ctx.key_indices);
+        rb_memerror();
+    }
+    ctx.signal->refcount = 1;
+    ctx.signal->completed = NULL;
+    uv_sem_init(&ctx.signal->sem, 0);
+    for (long i = ctx.concurrency - 1; i >= 0; i--) {
+        bulk_load_slot *slot = &ctx.signal->slots[i];
+
+        slot->future = NULL;
+        slot->signal = ctx.signal;
+        slot->next = ctx.free_slots;
+        ctx.free_slots = slot;
+    }
+
+    args.ctx = &ctx;
+    args.enumerable = enumerable;
+    started_at = bulk_load_now();
+    rb_ensure(bulk_load_body, (VALUE)&args, bulk_load_ensure, (VALUE)&ctx);
+
+    summary = rb_hash_new();
+    rb_hash_aset(summary, sym_rows, LONG2NUM(ctx.rows));
+    rb_hash_aset(summary, sym_succeeded, LONG2NUM(ctx.succeeded));
+    rb_hash_aset(summary, sym_failed, LONG2NUM(ctx.failed));
+    rb_hash_aset(summary, sym_requests, LONG2NUM(ctx.requests));
+    rb_hash_aset(summary, sym_errors, ctx.errors);
+    rb_hash_aset(summary, sym_elapsed, DBL2NUM(bulk_load_now() - started_at));
+
+    RB_GC_GUARD(ctx.statement);
+    RB_GC_GUARD(ctx.groups);
+    return summary;
+}
+
+void Init_bulk_load(void)
+{
+    rb_define_method(cSession, "bulk_load", session_bulk_load, -1);
+
+    sym_rows = ID2SYM(rb_intern("rows"));
+    sym_succeeded = ID2SYM(rb_intern("succeeded"));
+    sym_failed = ID2SYM(rb_intern("failed"));
+    sym_requests = ID2SYM(rb_intern("requests"));
+    sym_errors = ID2SYM(rb_intern("errors"));
+    sym_elapsed = ID2SYM(rb_intern("elapsed"));
+}
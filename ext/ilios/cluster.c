@@ -62,7 +62,7 @@ static VALUE cluster_connect(VALUE self)
     cassandra_session->cluster_obj = self;
     cassandra_session->session = cass_session_new();
     connect_future = cass_session_connect_keyspace(cassandra_session->session, cassandra_cluster->cluster, keyspace);
-    nogvl_future_wait(connect_future);
+    nogvl_future_wait_local(connect_future);
 
     if (cass_future_error_code(connect_future) != CASS_OK) {
         char error[4096] = { 0 };
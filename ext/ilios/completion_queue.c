@@ -0,0 +1,257 @@
+#include "ilios.h"
+
+static void completion_queue_mark(void *ptr);
+static void completion_queue_destroy(void *ptr);
+static size_t completion_queue_memsize(const void *ptr);
+static void completion_queue_compact(void *ptr);
+
+const rb_data_type_t cassandra_completion_queue_data_type = {
+    "Ilios::Cassandra::CompletionQueue",
+    {
+        completion_queue_mark,
+        completion_queue_destroy,
+        completion_queue_memsize,
+        completion_queue_compact,
+    },
+    0, 0,
+    RUBY_TYPED_FREE_IMMEDIATELY | RUBY_TYPED_WB_PROTECTED,
+};
+
+static VALUE completion_queue_alloc(VALUE klass)
+{
+    CassandraCompletionQueue *cassandra_completion_queue;
+    VALUE obj;
+
+    obj = TypedData_Make_Struct(klass, CassandraCompletionQueue, &cassandra_completion_queue_data_type, cassandra_completion_queue);
+    cassandra_completion_queue->queue.notify_fd = -1;
+    return obj;
+}
+
+/**
+ * Creates a completion queue.
+ *
+ * @return [Cassandra::CompletionQueue] A completion queue.
+ */
+static VALUE completion_queue_initialize(VALUE self)
+{
+    CassandraCompletionQueue *cassandra_completion_queue;
+    int fds[2];
+
+    GET_COMPLETION_QUEUE(self, cassandra_completion_queue);
+    if (cassandra_completion_queue->queue.notify_fd >= 0) {
+        rb_raise(eExecutionError, "CompletionQueue is already initialized");
+    }
+
+    if (rb_cloexec_pipe(fds) < 0) {
+        rb_sys_fail("pipe");
+    }
+    rb_update_max_fd(fds[1]);
+    // Driver IO threads write to the pipe and drain reads it until empty,
+    // so neither may block.
+    fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+    fcntl(fds[1], F_SETFL, fcntl(fds[1], F_GETFL) | O_NONBLOCK);
+    cassandra_completion_queue->queue.notify_fd = fds[1];
+    RB_OBJ_WRITE(self, &cassandra_completion_queue->io, rb_io_fdopen(fds[0], O_RDONLY, NULL));
+
+    return self;
+}
+
+static void completion_queue_signal(CassandraCompletionQueue *cassandra_completion_queue)
+{
+    char byte = 1;
+
+    while (write(cassandra_completion_queue->queue.notify_fd, &byte, 1) < 0 && errno == EINTR) {
+    }
+}
+
+static int completion_queue_fd(CassandraCompletionQueue *cassandra_completion_queue)
+{
+    if (cassandra_completion_queue->queue.notify_fd < 0) {
+        rb_raise(eExecutionError, "CompletionQueue is not initialized");
+    }
+#ifdef HAVE_RB_IO_DESCRIPTOR
+    return rb_io_descriptor(cassandra_completion_queue->io);
+#else
+    {
+        rb_io_t *fptr;
+
+        GetOpenFile(cassandra_completion_queue->io, fptr);
+        return fptr->fd;
+    }
+#endif
+}
+
+/**
+ * Attaches a future, so that its callbacks are run by {#drain} instead of a
+ * background thread. The future is kept alive until it has been drained.
+ *
+ * @param future [Cassandra::Future] A future.
+ * @return [Cassandra::CompletionQueue] self.
+ * @raise [Cassandra::ExecutionError] If the future already has a completion queue, e.g. because a callback was registered or it was awaited with {Cassandra::Future.await_all}.
+ */
+static VALUE completion_queue_attach(VALUE self, VALUE future)
+{
+    CassandraCompletionQueue *cassandra_completion_queue;
+
+    GET_COMPLETION_QUEUE(self, cassandra_completion_queue);
+    completion_queue_fd(cassandra_completion_queue);
+
+    future_completion_attach(future, self, &cassandra_completion_queue->queue);
+    return self;
+}
+
+/**
+ * Returns the IO which becomes readable when futures are ready to be drained.
+ * Its contents are not meant to be read, only to wait on it with +IO.select+
+ * or an event loop.
+ *
+ * @return [IO] The IO.
+ */
+static VALUE completion_queue_to_io(VALUE self)
+{
+    CassandraCompletionQueue *cassandra_completion_queue;
+
+    GET_COMPLETION_QUEUE(self, cassandra_completion_queue);
+    completion_queue_fd(cassandra_completion_queue);
+
+    return cassandra_completion_queue->io;
+}
+
+/**
+ * Returns the futures which are complete, in the order they completed, after
+ * running their callbacks on the calling thread. Never blocks.
+ *
+ * @param max [Integer, nil] The maximum number of futures to drain. If more are ready, the IO stays readable.
+ * @return [Array<Cassandra::Future>] The drained futures, empty if none is ready.
+ * @raise [ArgumentError] If an invalid max was given.
+ * @raise [StandardError] The first error raised by a callback, after all of them ran.
+ */
+static VALUE completion_queue_drain(int argc, VALUE *argv, VALUE self)
+{
+    static ID keywords[1];
+    CassandraCompletionQueue *cassandra_completion_queue;
+    CassandraFuture *taken;
+    VALUE options, futures;
+    VALUE max = Qundef;
+    VALUE error = Qnil;
+    long limit = -1;
+    char buffer[64];
+    int fd;
+
+    if (!keywords[0]) {
+        keywords[0] = rb_intern("max");
+    }
+    rb_scan_args(argc, argv, ":", &options);
+    if (!NIL_P(options)) {
+        rb_get_kwargs(options, keywords, 0, 1, &max);
+    }
+    if (max != Qundef && !NIL_P(max)) {
+        limit = NUM2LONG(max);
+        if (limit < 1) {
+            rb_raise(rb_eArgError, "Invalid max: %"PRIsVALUE"", max);
+        }
+    }
+
+    GET_COMPLETION_QUEUE(self, cassandra_completion_queue);
+    fd = completion_queue_fd(cassandra_completion_queue);
+
+    // Empty the pipe before taking, so that a future pushed in between
+    // signals it again rather than being left behind without a wakeup.
+    while (read(fd, buffer, sizeof(buffer)) > 0) {
+    }
+
+    taken = future_completion_take(&cassandra_completion_queue->queue);
+    if (taken) {
+        if (cassandra_completion_queue->ready_tail) {
+            cassandra_completion_queue->ready_tail->completion_next = taken;
+        } else {
+            cassandra_completion_queue->ready_head = taken;
+        }
+        while (taken->completion_next) {
+            taken = taken->completion_next;
+        }
+        cassandra_completion_queue->ready_tail = taken;
+    }
+
+    futures = rb_ary_new();
+    while (cassandra_completion_queue->ready_head && (limit < 0 || RARRAY_LEN(futures) < limit)) {
+        CassandraFuture *cassandra_future = cassandra_completion_queue->ready_head;
+
+        cassandra_completion_queue->ready_head = cassandra_future->completion_next;
+        if (cassandra_completion_queue->ready_head == NULL) {
+            cassandra_completion_queue->ready_tail = NULL;
+        }
+        rb_ary_push(futures, cassandra_future->future_obj);
+        future_completion_release(cassandra_future->future_obj);
+    }
+    if (cassandra_completion_queue->ready_head) {
+        // Keep the IO readable for the rest.
+        completion_queue_signal(cassandra_completion_queue);
+    }
+
+    for (long i = 0; i < RARRAY_LEN(futures); i++) {
+        int state = 0;
+
+        rb_protect(future_completion_dispatch, RARRAY_AREF(futures, i), &state);
+        if (state) {
+            VALUE exception = rb_errinfo();
+
+            if (!rb_obj_is_kind_of(exception, rb_eStandardError)) {
+                rb_jump_tag(state);
+            }
+            // A failing callback must not stop the callbacks of other futures.
+            rb_set_errinfo(Qnil);
+            if (NIL_P(error)) {
+                error = exception;
+            }
+        }
+    }
+    if (!NIL_P(error)) {
+        rb_exc_raise(error);
+    }
+
+    return futures;
+}
+
+static void completion_queue_mark(void *ptr)
+{
+    CassandraCompletionQueue *cassandra_completion_queue = (CassandraCompletionQueue *)ptr;
+
+    // Futures in the ready list are still pending (see future.c), which keeps
+    // them alive.
+    rb_gc_mark_movable(cassandra_completion_queue->io);
+}
+
+static void completion_queue_destroy(void *ptr)
+{
+    CassandraCompletionQueue *cassandra_completion_queue = (CassandraCompletionQueue *)ptr;
+
+    // Attached futures mark the queue until drained, so no driver callback can
+    // write to the pipe anymore. The read end is closed by its IO.
+    if (cassandra_completion_queue->queue.notify_fd >= 0) {
+        close(cassandra_completion_queue->queue.notify_fd);
+    }
+    xfree(cassandra_completion_queue);
+}
+
+static size_t completion_queue_memsize(const void *ptr)
+{
+    return sizeof(CassandraCompletionQueue);
+}
+
+static void completion_queue_compact(void *ptr)
+{
+    CassandraCompletionQueue *cassandra_completion_queue = (CassandraCompletionQueue *)ptr;
+
+    cassandra_completion_queue->io = rb_gc_location(cassandra_completion_queue->io);
+}
+
+void Init_completion_queue(void)
+{
+    rb_define_alloc_func(cCompletionQueue, completion_queue_alloc);
+
+    rb_define_method(cCompletionQueue, "initialize", completion_queue_initialize, 0);
+    rb_define_method(cCompletionQueue, "attach", completion_queue_attach, 1);
+    rb_define_method(cCompletionQueue, "to_io", completion_queue_to_io, 0);
+    rb_define_method(cCompletionQueue, "drain", completion_queue_drain, -1);
+}
@@ -7,8 +7,12 @@ require 'mini_portile2'
 require 'mkmf'
 require 'rbconfig'
 
-have_func('malloc_usable_size')
-have_func('malloc_size')
+have_func('rb_io_buffer_get_bytes_for_reading', 'ruby/io/buffer.h')
+have_func('rb_io_buffer_get_bytes_for_writing', 'ruby/io/buffer.h')
+have_func('rb_io_buffer_new', 'ruby/io/buffer.h')
+have_func('rb_hash_new_capa')
+have_func('rb_fiber_scheduler_current', 'ruby/fiber/scheduler.h')
+have_func('rb_io_descriptor', 'ruby/io.h')
 
 module LibuvInstaller
   LIBUV_INSTALL_PATH = File.expand_path('libuv')
@@ -1,18 +1,66 @@
 #include "ilios.h"
 
-#define THREAD_MAX 5
-#define QUEUE_MAX 100
+static future_completion_queue completion_queue;
+// Futures with a registered driver callback. Keeps them alive until they have
+// been popped from their completion queue.
+static VALUE completion_pending;
+
+// Future#await was called, or the dispatcher handled the future.
+#define FUTURE_WAITED     0x1
+// A callback was run.
+#define FUTURE_YIELDED    0x2
+// The driver callback was registered.
+#define FUTURE_REGISTERED 0x4
+// A chained future has its value or error.
+#define FUTURE_RESOLVED   0x8
+
+// Structs of collected futures, reused by future_create so that creating a
+// future allocates only its Ruby object. Bounded, so that a burst of futures
+// doesn't pin memory.
+#define FUTURE_POOL_SIZE 256
+
+static struct
+{
+    uv_mutex_t lock;
+    CassandraFuture *head;
+    size_t count;
+} future_pool;
+
+// Marks the waiter list of a future whose driver callback already fired.
+#define FUTURE_WAITERS_DONE ((future_waiter_link *)1)
+
+/*
+ * A single Future.await_all or Future.await_any call. Linked from each future
+ * it waits for, whose driver callback counts it and wakes only this thread.
+ * Allocated with malloc and reference counted, as the last reference may be
+ * dropped by a callback on a driver IO thread after the wait returned.
+ */
+typedef struct future_waiter
+{
+    uv_mutex_t lock;
+    uv_cond_t cond;
+    // One for the waiting thread, plus one per link not yet notified.
+    rb_atomic_t refcount;
+    // Number of completed futures to wait for, SIZE_MAX while linking, and
+    // completed so far.
+    size_t needed;
+    size_t completed;
+    // Absolute uv_hrtime deadline, or 0 to wait without a timeout.
+    uint64_t deadline;
+    bool done;
+    bool interrupted;
+    future_waiter_link links[];
+} future_waiter;
 
 typedef struct
 {
-    VALUE thread[THREAD_MAX];
-    VALUE queue;
-} future_thread_pool;
+    VALUE futures;
+    bool any;
+    future_waiter *waiter;
+    bool done;
+} future_wait_many;
 
-static future_thread_pool thread_pool_prepare;
-static future_thread_pool thread_pool_execute;
-
-static VALUE future_result_yielder_thread(void *arg);
+static VALUE future_completion_dispatcher_thread(void *arg);
 static void future_mark(void *ptr);
 static void future_destroy(void *ptr);
 static size_t future_memsize(const void *ptr);
@@ -30,102 +78,255 @@ const rb_data_type_t cassandra_future_data_type = {
     RUBY_TYPED_FREE_IMMEDIATELY | RUBY_TYPED_WB_PROTECTED | RUBY_TYPED_FROZEN_SHAREABLE,
 };
 
-static void future_thread_pool_init(future_thread_pool *pool)
+/*
+ * Sets a state flag, returning false if it was already set.
+ */
+static bool future_state_set(CassandraFuture *cassandra_future, rb_atomic_t flag)
 {
-    pool->queue = rb_funcall(cSizedQueue, id_new, 1, INT2NUM(QUEUE_MAX));
-    rb_gc_register_mark_object(pool->queue);
+    rb_atomic_t state;
 
-    // Register each slot once. The slots stay zero (Qfalse) until a thread is
-    // assigned; re-registering on every thread (re)creation would leak entries
-    // in the global address list.
-    for (int i = 0; i < THREAD_MAX; i++) {
-        rb_gc_register_address(&pool->thread[i]);
-    }
+    do {
+        state = cassandra_future->state;
+        if (state & flag) {
+            return false;
+        }
+    } while (RUBY_ATOMIC_CAS(cassandra_future->state, state, state | flag) != state);
+    return true;
 }
 
-static void future_thread_pool_prepare_thread(future_thread_pool *pool)
+/*
+ * Returns whether the future's request finished or, for a chained future,
+ * whether it has its value or error.
+ */
+static bool future_complete(CassandraFuture *cassandra_future)
 {
-    VALUE status;
-
-    for (int i = 0; i < THREAD_MAX; i++) {
-        status = Qfalse;
+    if (cassandra_future->kind == chain_async) {
+        return (cassandra_future->state & FUTURE_RESOLVED) != 0;
+    }
+    return cass_future_ready(cassandra_future->future) == cass_true;
+}
 
-        if (pool->thread[i]) {
-            status = rb_funcall(pool->thread[i], id_alive, 0);
-        }
-        if (!pool->thread[i] || !RTEST(status)) {
-            pool->thread[i] = rb_thread_create(future_result_yielder_thread, (void*)pool);
-            rb_funcall(pool->thread[i], id_report_on_exception, 1, Qtrue);
-        }
+static bool future_failed(CassandraFuture *cassandra_future)
+{
+    if (cassandra_future->kind == chain_async) {
+        return cassandra_future->error != 0;
     }
+    return cass_future_error_code(cassandra_future->future) != CASS_OK;
 }
 
-static inline future_thread_pool *future_thread_pool_get(CassandraFuture *cassandra_future)
+/*
+ * Returns the value of a successfully completed future, creating its
+ * Statement or Result on first use.
+ */
+static VALUE future_value(CassandraFuture *cassandra_future)
 {
-    future_thread_pool *pool = NULL;
+    VALUE obj = Qnil;
+
+    if (cassandra_future->value || cassandra_future->kind == chain_async) {
+        return cassandra_future->value;
+    }
 
     switch (cassandra_future->kind) {
     case prepare_async:
-        pool = &thread_pool_prepare;
+        {
+            CassandraStatement *cassandra_statement;
+
+            obj = CREATE_STATEMENT(cassandra_statement);
+            cassandra_statement->prepared = cass_future_get_prepared(cassandra_future->future);
+            cassandra_statement->session_obj = cassandra_future->session_obj;
+
+            statement_default_config(cassandra_statement);
+        }
         break;
     case execute_async:
-        pool = &thread_pool_execute;
+        {
+            CassandraResult *cassandra_result;
+
+            obj = CREATE_RESULT(cassandra_result);
+            result_set_page(cassandra_result, cass_future_get_result(cassandra_future->future));
+            cassandra_result->statement_obj = cassandra_future->statement_obj;
+            // Hand over the executed CassStatement so Result#next_page
+            // can reuse it and it gets freed exactly once.
+            cassandra_result->executed_statement = cassandra_future->executed_statement;
+            cassandra_future->executed_statement = NULL;
+        }
+        break;
+    case chain_async:
         break;
     }
-    return pool;
+
+    RB_OBJ_WRITE(cassandra_future->future_obj, &cassandra_future->value, obj);
+    return obj;
 }
 
-static inline void future_queue_push(future_thread_pool *pool, VALUE future)
+/*
+ * Returns the exception of a failed future.
+ */
+static VALUE future_error(CassandraFuture *cassandra_future)
 {
-    rb_funcall(pool->queue, id_push, 1, future);
-    future_thread_pool_prepare_thread(pool);
+    const char *error;
+
+    if (cassandra_future->kind == chain_async) {
+        return cassandra_future->error;
+    }
+
+    error = cass_error_desc(cass_future_error_code(cassandra_future->future));
+    if (cassandra_future->kind == prepare_async) {
+        return rb_exc_new_str(eExecutionError, rb_sprintf("Unable to prepare query: %s", error));
+    }
+    return rb_exc_new_str(eExecutionError, rb_sprintf("Unable to wait executing: %s", error));
 }
 
-static inline VALUE future_queue_pop(future_thread_pool *pool)
+static void future_completion_queue_init(future_completion_queue *queue)
 {
-    return rb_funcall(pool->queue, id_pop, 0);
+    queue->head = NULL;
+    queue->notify_fd = -1;
+    uv_sem_init(&queue->sem, 0);
+    rb_gc_register_address(&queue->thread);
+
+    completion_pending = rb_hash_new();
+    rb_gc_register_mark_object(completion_pending);
 }
 
-static void future_result_success_yield(CassandraFuture *cassandra_future)
+static void future_completion_prepare_thread(future_completion_queue *queue)
 {
-    VALUE obj;
-
-    if (cassandra_future->on_success_block) {
-        if (rb_proc_arity(cassandra_future->on_success_block)) {
-            switch (cassandra_future->kind) {
-            case prepare_async:
-                {
-                    CassandraStatement *cassandra_statement;
-                    VALUE cassandra_statement_obj;
+    VALUE status = Qfalse;
 
-                    cassandra_statement_obj = CREATE_STATEMENT(cassandra_statement);
-                    cassandra_statement->prepared = cass_future_get_prepared(cassandra_future->future);
-                    cassandra_statement->statement = cass_prepared_bind(cassandra_statement->prepared);
-                    cassandra_statement->session_obj = cassandra_future->session_obj;
+    if (queue->thread) {
+        status = rb_funcall(queue->thread, id_alive, 0);
+    }
+    if (!queue->thread || !RTEST(status)) {
+        queue->thread = rb_thread_create(future_completion_dispatcher_thread, (void*)queue);
+        rb_funcall(queue->thread, id_report_on_exception, 1, Qtrue);
+    }
+}
 
-                    statement_default_config(cassandra_statement);
+static void future_completion_push(future_completion_queue *queue, CassandraFuture *cassandra_future)
+{
+    CassandraFuture *head;
+
+    do {
+        head = queue->head;
+        cassandra_future->completion_next = head;
+    } while (RUBY_ATOMIC_PTR_CAS(queue->head, head, cassandra_future) != head);
+
+    if (head == NULL) {
+        // The dispatcher only sleeps while the queue is empty, so a single
+        // wakeup per empty -> non-empty transition is enough.
+        if (queue->notify_fd < 0) {
+            uv_sem_post(&queue->sem);
+        } else {
+            char byte = 1;
 
-                    obj = cassandra_statement_obj;
-                }
-                break;
-            case execute_async:
-                {
-                    CassandraResult *cassandra_result;
-                    VALUE cassandra_result_obj;
-
-                    cassandra_result_obj = CREATE_RESULT(cassandra_result);
-                    cassandra_result->result = cass_future_get_result(cassandra_future->future);
-                    cassandra_result->statement_obj = cassandra_future->statement_obj;
-                    // Hand over the executed CassStatement so Result#next_page
-                    // can reuse it and it gets freed exactly once.
-                    cassandra_result->executed_statement = cassandra_future->executed_statement;
-                    cassandra_future->executed_statement = NULL;
-
-                    obj = cassandra_result_obj;
-                }
-                break;
+            // Non-blocking, and the pipe can't fill up as it is emptied
+            // before every take.
+            while (write(queue->notify_fd, &byte, 1) < 0 && errno == EINTR) {
             }
+        }
+    }
+}
+
+CassandraFuture *future_completion_take(future_completion_queue *queue)
+{
+    CassandraFuture *list = RUBY_ATOMIC_PTR_EXCHANGE(queue->head, NULL);
+    CassandraFuture *ordered = NULL;
+
+    // Reverse the LIFO so that callbacks run in the order futures completed.
+    while (list) {
+        CassandraFuture *next = list->completion_next;
+
+        list->completion_next = ordered;
+        ordered = list;
+        list = next;
+    }
+    return ordered;
+}
+
+static void future_waiter_release(future_waiter *waiter)
+{
+    if (RUBY_ATOMIC_FETCH_SUB(waiter->refcount, 1) == 1) {
+        uv_cond_destroy(&waiter->cond);
+        uv_mutex_destroy(&waiter->lock);
+        free(waiter);
+    }
+}
+
+static void future_waiter_notify(future_waiter_link *link)
+{
+    while (link) {
+        // Read before releasing, which may free the link's waiter.
+        future_waiter_link *next = link->next;
+        future_waiter *waiter = link->waiter;
+
+        uv_mutex_lock(&waiter->lock);
+        if (++waiter->completed >= waiter->needed) {
+            uv_cond_signal(&waiter->cond);
+        }
+        uv_mutex_unlock(&waiter->lock);
+        future_waiter_release(waiter);
+        link = next;
+    }
+}
+
+static void future_completion_cb(CassFuture *future, void *data)
+{
+    CassandraFuture *cassandra_future = (CassandraFuture *)data;
+
+    // Runs on a driver IO thread without the GVL: no Ruby API may be used here.
+#ifdef HAVE_RB_FIBER_SCHEDULER_CURRENT
+    // Before pushing: once dispatched, the struct may be collected and recycled.
+    nogvl_fiber_signal_notify_all(&cassandra_future->fiber_signals);
+#endif
+    future_waiter_notify(RUBY_ATOMIC_PTR_EXCHANGE(cassandra_future->waiters, FUTURE_WAITERS_DONE));
+    future_completion_push(cassandra_future->completion_queue ? cassandra_future->completion_queue : &completion_queue, cassandra_future);
+}
+
+static void future_completion_register(VALUE future)
+{
+    CassandraFuture *cassandra_future;
+
+    GET_FUTURE(future, cassandra_future);
+
+    rb_hash_aset(completion_pending, future, Qtrue);
+    if (cassandra_future->completion_queue == NULL) {
+        future_completion_prepare_thread(&completion_queue);
+    }
+    cass_future_set_callback(cassandra_future->future, future_completion_cb, cassandra_future);
+}
+
+/*
+ * Attaches the future to a CompletionQueue, whose drain then runs its
+ * callbacks instead of the internal dispatcher.
+ */
+void future_completion_attach(VALUE future, VALUE queue_obj, future_completion_queue *queue)
+{
+    CassandraFuture *cassandra_future;
+
+    GET_FUTURE(future, cassandra_future);
+
+    if (!future_state_set(cassandra_future, FUTURE_REGISTERED)) {
+        rb_raise(eExecutionError, "Future already has a completion queue");
+    }
+    cassandra_future->completion_queue = queue;
+    RB_OBJ_WRITE(future, &cassandra_future->completion_queue_obj, queue_obj);
+    future_completion_register(future);
+}
+
+/*
+ * Lets a future popped from its completion queue be collected again.
+ */
+void future_completion_release(VALUE future)
+{
+    rb_hash_delete(completion_pending, future);
+}
+
+static void future_result_success_yield(CassandraFuture *cassandra_future)
+{
+    VALUE obj;
 
+    if (cassandra_future->on_success_block) {
+        if (rb_proc_arity(cassandra_future->on_success_block)) {
+            obj = future_value(cassandra_future);
             rb_proc_call_with_block(cassandra_future->on_success_block, 1, &obj, Qnil);
         } else {
             rb_proc_call_with_block(cassandra_future->on_success_block, 0, NULL, Qnil);
@@ -146,54 +347,120 @@ static VALUE future_result_yielder_synchronize(VALUE future)
 
     GET_FUTURE(future, cassandra_future);
 
-    if (!cassandra_future->yielded) {
-        if (cass_future_error_code(cassandra_future->future) == CASS_OK) {
-            if (cassandra_future->on_success_block) {
-                cassandra_future->yielded = true;
-                future_result_success_yield(cassandra_future);
-            }
-        } else {
-            if (cassandra_future->on_failure_block) {
-                cassandra_future->yielded = true;
-                future_result_failure_yield(cassandra_future);
-            }
+    if (!future_failed(cassandra_future)) {
+        if (cassandra_future->on_success_block && future_state_set(cassandra_future, FUTURE_YIELDED)) {
+            future_result_success_yield(cassandra_future);
+        }
+    } else {
+        if (cassandra_future->on_failure_block && future_state_set(cassandra_future, FUTURE_YIELDED)) {
+            future_result_failure_yield(cassandra_future);
         }
     }
-    cassandra_future->already_waited = true;
+    future_state_set(cassandra_future, FUTURE_WAITED);
     return Qnil;
 }
 
-static VALUE future_result_yielder_body(VALUE future)
+static VALUE future_yield(VALUE future)
 {
     CassandraFuture *cassandra_future;
 
     GET_FUTURE(future, cassandra_future);
-
-    nogvl_future_wait(cassandra_future->future);
+    // Futures registered only to be waited on have no callbacks. One added
+    // later sees the future complete and runs right away.
+    if (!cassandra_future->proc_mutex) {
+        return Qnil;
+    }
     return rb_mutex_synchronize(cassandra_future->proc_mutex, future_result_yielder_synchronize, future);
 }
 
-static VALUE future_result_yielder_ensure(VALUE future)
+static VALUE future_chain_advance_protect(VALUE chain);
+
+/*
+ * Advances the chained futures following a future which just completed.
+ */
+static VALUE future_complete_dependents(VALUE future)
 {
     CassandraFuture *cassandra_future;
+    VALUE dependents;
+    VALUE error = Qnil;
 
     GET_FUTURE(future, cassandra_future);
-    uv_sem_post(&cassandra_future->sem);
+    dependents = cassandra_future->dependents;
+    if (!dependents) {
+        return Qnil;
+    }
+    cassandra_future->dependents = 0;
+
+    for (long i = 0; i < RARRAY_LEN(dependents); i++) {
+        int state = 0;
+
+        rb_protect(future_chain_advance_protect, RARRAY_AREF(dependents, i), &state);
+        if (state) {
+            VALUE exception = rb_errinfo();
+
+            if (!rb_obj_is_kind_of(exception, rb_eStandardError)) {
+                rb_jump_tag(state);
+            }
+            // A failing callback of one chain must not stall the others.
+            rb_set_errinfo(Qnil);
+            if (NIL_P(error)) {
+                error = exception;
+            }
+        }
+    }
+    RB_GC_GUARD(dependents);
+    if (!NIL_P(error)) {
+        rb_exc_raise(error);
+    }
     return Qnil;
 }
 
-static VALUE future_result_yielder(VALUE future)
+/*
+ * Runs the callbacks of a future popped from its completion queue, and then
+ * the stages chained after it.
+ */
+VALUE future_completion_dispatch(VALUE future)
 {
-    return rb_ensure(future_result_yielder_body, future, future_result_yielder_ensure, future);
+    return rb_ensure(future_yield, future, future_complete_dependents, future);
 }
 
-static VALUE future_result_yielder_thread(void *arg)
+static VALUE future_completion_dispatcher_thread(void *arg)
 {
-    future_thread_pool *pool = (future_thread_pool *)arg;
+    future_completion_queue *queue = (future_completion_queue *)arg;
 
     while (1) {
-        VALUE future = future_queue_pop(pool);
-        future_result_yielder(future);
+        CassandraFuture *cassandra_future;
+
+        nogvl_sem_wait(&queue->sem);
+
+        cassandra_future = future_completion_take(queue);
+        while (cassandra_future) {
+            CassandraFuture *next = cassandra_future->completion_next;
+            VALUE future = cassandra_future->future_obj;
+            VALUE error;
+            int state = 0;
+
+            rb_protect(future_completion_dispatch, future, &state);
+            future_completion_release(future);
+
+            if (state) {
+                error = rb_errinfo();
+                if (!rb_obj_is_kind_of(error, rb_eStandardError)) {
+                    // The dispatcher is being killed: hand the rest of the batch
+                    // back to the queue for the next dispatcher thread.
+                    while (next) {
+                        cassandra_future = next->completion_next;
+                        future_completion_push(queue, next);
+                        next = cassandra_future;
+                    }
+                    rb_jump_tag(state);
+                }
+                // A failing callback must not stop the callbacks of other futures.
+                rb_set_errinfo(Qnil);
+                rb_io_write(rb_stderr, rb_funcall(error, id_full_message, 0));
+            }
+            cassandra_future = next;
+        }
     }
     return Qnil;
 }
@@ -203,46 +470,261 @@ VALUE future_create(CassFuture *future, VALUE session, VALUE statement, future_k
     CassandraFuture *cassandra_future;
     VALUE cassandra_future_obj;
 
-    cassandra_future_obj = CREATE_FUTURE(cassandra_future);
+    // Wrap first, so that the struct can't leak if allocating the object fails.
+    cassandra_future_obj = TypedData_Wrap_Struct(cFuture, &cassandra_future_data_type, NULL);
+
+    uv_mutex_lock(&future_pool.lock);
+    cassandra_future = future_pool.head;
+    if (cassandra_future) {
+        future_pool.head = cassandra_future->completion_next;
+        future_pool.count--;
+    }
+    uv_mutex_unlock(&future_pool.lock);
+    if (cassandra_future == NULL) {
+        cassandra_future = ALLOC(CassandraFuture);
+    }
+
+    MEMZERO(cassandra_future, CassandraFuture, 1);
     cassandra_future->kind = kind;
     cassandra_future->future = future;
-    cassandra_future->executed_statement = NULL;
+    cassandra_future->future_obj = cassandra_future_obj;
     cassandra_future->session_obj = session;
     cassandra_future->statement_obj = statement;
-    cassandra_future->proc_mutex = rb_mutex_new();
-    uv_sem_init(&cassandra_future->sem, 0);
-    cassandra_future->already_waited = false;
-    cassandra_future->yielded = false;
+    DATA_PTR(cassandra_future_obj) = cassandra_future;
 
     return cassandra_future_obj;
 }
 
+static void future_prepare_mutex(VALUE self, CassandraFuture *cassandra_future)
+{
+    // Nothing in between can switch threads, so no other thread can create
+    // one concurrently.
+    if (!cassandra_future->proc_mutex) {
+        RB_OBJ_WRITE(self, &cassandra_future->proc_mutex, rb_mutex_new());
+    }
+}
+
+typedef struct
+{
+    VALUE block;
+    VALUE value;
+} future_chain_call_args;
+
+/*
+ * Makes the chained future run its stage after the source future.
+ */
+static void future_chain_follow(VALUE chain, CassandraFuture *cassandra_chain, VALUE source)
+{
+    CassandraFuture *cassandra_source;
+
+    GET_FUTURE(source, cassandra_source);
+    RB_OBJ_WRITE(chain, &cassandra_chain->source_obj, source);
+
+    if (!cassandra_source->dependents) {
+        RB_OBJ_WRITE(source, &cassandra_source->dependents, rb_ary_new());
+    }
+    rb_ary_push(cassandra_source->dependents, chain);
+
+    // Have the completion path advance the chain, so that the next stage is
+    // submitted as soon as the request finished.
+    if (cassandra_source->kind != chain_async && !future_complete(cassandra_source) &&
+        future_state_set(cassandra_source, FUTURE_REGISTERED)) {
+        future_completion_register(source);
+    }
+}
+
+static void future_chain_resolve(VALUE chain, CassandraFuture *cassandra_chain, bool failed, VALUE value)
+{
+    if (failed) {
+        RB_OBJ_WRITE(chain, &cassandra_chain->error, value);
+    } else {
+        RB_OBJ_WRITE(chain, &cassandra_chain->value, value);
+    }
+    future_state_set(cassandra_chain, FUTURE_RESOLVED);
+    cassandra_chain->source_obj = Qnil;
+    cassandra_chain->chain_block = Qnil;
+}
+
+static VALUE future_chain_call(VALUE ptr)
+{
+    future_chain_call_args *args = (future_chain_call_args *)ptr;
+
+    return rb_proc_call_with_block(args->block, 1, &args->value, Qnil);
+}
+
+static VALUE future_chain_call_rescue(VALUE ptr, VALUE exception)
+{
+    *(bool *)ptr = true;
+    return exception;
+}
+
+static VALUE future_chain_advance_synchronize(VALUE chain)
+{
+    CassandraFuture *cassandra_chain;
+
+    GET_FUTURE(chain, cassandra_chain);
+    if (cassandra_chain->state & FUTURE_RESOLVED) {
+        return Qfalse;
+    }
+
+    while (1) {
+        future_chain_call_args args;
+        CassandraFuture *cassandra_source;
+        VALUE result;
+        bool failed, raised = false;
+
+        GET_FUTURE(cassandra_chain->source_obj, cassandra_source);
+        if (!future_complete(cassandra_source)) {
+            // Advanced again when the source completes.
+            return Qfalse;
+        }
+        failed = future_failed(cassandra_source);
+        args.value = failed ? future_error(cassandra_source) : future_value(cassandra_source);
+
+        if (cassandra_chain->chain_stage == future_chain_adopt ||
+            failed != (cassandra_chain->chain_stage == future_chain_rescue)) {
+            // Nothing to run: pass the value or error on.
+            future_chain_resolve(chain, cassandra_chain, failed, args.value);
+            return Qtrue;
+        }
+
+        args.block = cassandra_chain->chain_block;
+        result = rb_rescue2(future_chain_call, (VALUE)&args, future_chain_call_rescue, (VALUE)&raised, rb_eStandardError, (VALUE)0);
+        RB_GC_GUARD(args.block);
+        if (raised) {
+            future_chain_resolve(chain, cassandra_chain, true, result);
+            return Qtrue;
+        }
+        if (cassandra_chain->chain_stage == future_chain_map || !rb_typeddata_is_kind_of(result, &cassandra_future_data_type)) {
+            future_chain_resolve(chain, cassandra_chain, false, result);
+            return Qtrue;
+        }
+
+        // The block submitted the next request: complete with it.
+        cassandra_chain->chain_stage = future_chain_adopt;
+        cassandra_chain->chain_block = Qnil;
+        future_chain_follow(chain, cassandra_chain, result);
+    }
+}
+
+/*
+ * Runs the chained future's stage if the future it follows is complete,
+ * then its callbacks and the stages chained after it. Does nothing until the
+ * source is complete, or while the stage is running on the current thread.
+ */
+static void future_chain_advance(VALUE chain)
+{
+    CassandraFuture *cassandra_chain;
+    CassandraFuture *cassandra_source;
+
+    GET_FUTURE(chain, cassandra_chain);
+    if (cassandra_chain->state & FUTURE_RESOLVED) {
+        return;
+    }
+    GET_FUTURE(cassandra_chain->source_obj, cassandra_source);
+    if (cassandra_source->kind == chain_async && !future_complete(cassandra_source)) {
+        // Completing the source advances this chain through its dependents.
+        future_chain_advance(cassandra_chain->source_obj);
+        return;
+    }
+    if (RTEST(rb_funcall(cassandra_chain->proc_mutex, id_owned, 0))) {
+        return;
+    }
+
+    if (RTEST(rb_mutex_synchronize(cassandra_chain->proc_mutex, future_chain_advance_synchronize, chain))) {
+        rb_ensure(future_yield, chain, future_complete_dependents, chain);
+    }
+}
+
+static VALUE future_chain_advance_protect(VALUE chain)
+{
+    future_chain_advance(chain);
+    return Qnil;
+}
+
+static VALUE future_chain_create(VALUE source, future_chain_stage stage)
+{
+    CassandraFuture *cassandra_chain;
+    VALUE chain;
+
+    if (!rb_block_given_p()) {
+        rb_raise(rb_eArgError, "no block given");
+    }
+
+    chain = future_create(NULL, Qnil, Qnil, chain_async);
+    GET_FUTURE(chain, cassandra_chain);
+    cassandra_chain->chain_stage = stage;
+    RB_OBJ_WRITE(chain, &cassandra_chain->chain_block, rb_block_proc());
+    future_prepare_mutex(chain, cassandra_chain);
+
+    future_chain_follow(chain, cassandra_chain, source);
+    // Runs right away if the source is already complete.
+    future_chain_advance(chain);
+    return chain;
+}
+
+/**
+ * Chains a stage after the future: once it succeeds, the block is called
+ * with its value on the thread completing it. If the block returns a future,
+ * e.g. by executing a dependent statement, the chained future completes with
+ * that future. Failures skip the block.
+ *
+ * @yieldparam value [Cassandra::Statement, Cassandra::Result, Object] The value of the future.
+ * @return [Cassandra::Future] A future for the value of the block, or of the future it returned.
+ * @raise [ArgumentError] If no block was given.
+ */
+static VALUE future_then(VALUE self)
+{
+    return future_chain_create(self, future_chain_then);
+}
+
+/**
+ * Chains a stage after the future: once it succeeds, the block is called
+ * with its value on the thread completing it. Failures skip the block.
+ *
+ * @yieldparam value [Cassandra::Statement, Cassandra::Result, Object] The value of the future.
+ * @return [Cassandra::Future] A future for the value of the block.
+ * @raise [ArgumentError] If no block was given.
+ */
+static VALUE future_map(VALUE self)
+{
+    return future_chain_create(self, future_chain_map);
+}
+
+/**
+ * Chains a stage after the future: if it fails, the block is called with the
+ * error on the thread completing it, and its value, or the future it returned,
+ * replaces the failure. Successful values skip the block.
+ *
+ * @yieldparam error [StandardError] The error, a +Cassandra::ExecutionError+ if a statement failed.
+ * @return [Cassandra::Future] A future for the value of the future, or else of the block.
+ * @raise [ArgumentError] If no block was given.
+ */
+static VALUE future_rescue(VALUE self)
+{
+    return future_chain_create(self, future_chain_rescue);
+}
+
 static VALUE future_on_success_synchronize(VALUE future)
 {
     CassandraFuture *cassandra_future;
-    bool wakeup_thread = false;
 
     GET_FUTURE(future, cassandra_future);
 
-    if (!cassandra_future->on_failure_block) {
-        // Invoke the callback with thread pool only once
-        wakeup_thread = true;
-    }
-
     RB_OBJ_WRITE(future, &cassandra_future->on_success_block, rb_block_proc());
 
-    if (cass_future_ready(cassandra_future->future)) {
-        uv_sem_post(&cassandra_future->sem);
-        if (!cassandra_future->yielded &&
-            cass_future_error_code(cassandra_future->future) == CASS_OK) {
-            cassandra_future->yielded = true;
+    if (future_complete(cassandra_future)) {
+        if (!future_failed(cassandra_future) &&
+            future_state_set(cassandra_future, FUTURE_YIELDED)) {
             future_result_success_yield(cassandra_future);
         }
         return future;
     }
 
-    if (wakeup_thread) {
-        future_queue_push(future_thread_pool_get(cassandra_future), future);
+    // Register the driver callback only once per future. Chained futures
+    // run their callbacks when they complete.
+    if (cassandra_future->kind != chain_async && future_state_set(cassandra_future, FUTURE_REGISTERED)) {
+        future_completion_register(future);
     }
 
     return future;
@@ -270,6 +752,7 @@ static VALUE future_on_success(VALUE self)
     if (!rb_block_given_p()) {
         rb_raise(rb_eArgError, "no block given");
     }
+    future_prepare_mutex(self, cassandra_future);
 
     return rb_mutex_synchronize(cassandra_future->proc_mutex, future_on_success_synchronize, self);
 }
@@ -277,29 +760,23 @@ static VALUE future_on_success(VALUE self)
 static VALUE future_on_failure_synchronize(VALUE future)
 {
     CassandraFuture *cassandra_future;
-    bool wakeup_thread = false;
 
     GET_FUTURE(future, cassandra_future);
 
-    if (!cassandra_future->on_success_block) {
-        // Invoke the callback with thread pool only once
-        wakeup_thread = true;
-    }
-
     RB_OBJ_WRITE(future, &cassandra_future->on_failure_block, rb_block_proc());
 
-    if (cass_future_ready(cassandra_future->future)) {
-        uv_sem_post(&cassandra_future->sem);
-        if (!cassandra_future->yielded &&
-            cass_future_error_code(cassandra_future->future) != CASS_OK) {
-            cassandra_future->yielded = true;
+    if (future_complete(cassandra_future)) {
+        if (future_failed(cassandra_future) &&
+            future_state_set(cassandra_future, FUTURE_YIELDED)) {
             future_result_failure_yield(cassandra_future);
         }
         return future;
     }
 
-    if (wakeup_thread) {
-        future_queue_push(future_thread_pool_get(cassandra_future), future);
+    // Register the driver callback only once per future. Chained futures
+    // run their callbacks when they complete.
+    if (cassandra_future->kind != chain_async && future_state_set(cassandra_future, FUTURE_REGISTERED)) {
+        future_completion_register(future);
     }
 
     return future;
@@ -324,12 +801,112 @@ static VALUE future_on_failure(VALUE self)
     if (!rb_block_given_p()) {
         rb_raise(rb_eArgError, "no block given");
     }
+    future_prepare_mutex(self, cassandra_future);
 
     return rb_mutex_synchronize(cassandra_future->proc_mutex, future_on_failure_synchronize, self);
 }
 
+#ifdef HAVE_RB_FIBER_SCHEDULER_CURRENT
+/*
+ * Waits for the future in the current fiber only. The driver's callback is
+ * taken by the completion queue, which signals the fiber when it runs.
+ */
+static void future_fiber_await(VALUE self, CassandraFuture *cassandra_future, VALUE scheduler)
+{
+    nogvl_fiber_signal *signal;
+    VALUE io;
+
+    if (future_state_set(cassandra_future, FUTURE_REGISTERED)) {
+        future_completion_register(self);
+    }
+
+    signal = nogvl_fiber_signal_acquire(&io);
+    if (!nogvl_fiber_signal_link(&cassandra_future->fiber_signals, signal)) {
+        // The callback already ran, so the future is ready and nothing will
+        // use the notifier's reference.
+        nogvl_fiber_signal_release(signal);
+    }
+    nogvl_fiber_wait(scheduler, cassandra_future->future, signal, io, false);
+}
+#endif
+
+/*
+ * Blocks until the request of a future which is not chained finished, or
+ * only the current fiber under a fiber scheduler.
+ */
+static void future_wait(VALUE self, CassandraFuture *cassandra_future)
+{
+    if (cass_future_ready(cassandra_future->future) == cass_false) {
+        VALUE scheduler = nogvl_fiber_scheduler();
+
+        if (NIL_P(scheduler)) {
+            nogvl_future_wait(cassandra_future->future);
+        } else {
+#ifdef HAVE_RB_FIBER_SCHEDULER_CURRENT
+            future_fiber_await(self, cassandra_future, scheduler);
+#endif
+        }
+    }
+}
+
+/*
+ * Returns the future the chained future is waiting for: its source, or the
+ * source's source and so on while those are chained futures not complete.
+ */
+static VALUE future_chain_leaf(VALUE future)
+{
+    CassandraFuture *cassandra_future;
+
+    GET_FUTURE(future, cassandra_future);
+    while (cassandra_future->kind == chain_async && !future_complete(cassandra_future)) {
+        future = cassandra_future->source_obj;
+        GET_FUTURE(future, cassandra_future);
+    }
+    return future;
+}
+
+/*
+ * Runs the stages of a chained future until it is complete, returning nil,
+ * or until it waits for a request, returning that request's future. Stages
+ * run here if the completion path has not reached them yet, or else this
+ * waits on their mutex for it to finish running them.
+ */
+static VALUE future_chain_pending(VALUE chain)
+{
+    CassandraFuture *cassandra_chain;
+
+    GET_FUTURE(chain, cassandra_chain);
+    while (!future_complete(cassandra_chain)) {
+        VALUE leaf = future_chain_leaf(chain);
+        CassandraFuture *cassandra_leaf;
+
+        GET_FUTURE(leaf, cassandra_leaf);
+        if (cassandra_leaf->kind != chain_async && !future_complete(cassandra_leaf)) {
+            return leaf;
+        }
+        future_chain_advance(chain);
+        // Only a stage running on this thread can't be advanced.
+        if (!future_complete(cassandra_chain) && future_chain_leaf(chain) == leaf) {
+            rb_raise(eExecutionError, "Future can't be awaited from a block of its own chain");
+        }
+    }
+    return Qnil;
+}
+
+static void future_chain_await(VALUE self)
+{
+    VALUE leaf;
+
+    while (!NIL_P(leaf = future_chain_pending(self))) {
+        CassandraFuture *cassandra_leaf;
+
+        GET_FUTURE(leaf, cassandra_leaf);
+        future_wait(leaf, cassandra_leaf);
+    }
+}
+
 /**
- * Wait to complete a future's statement.
+ * Wait to complete a future's statement, or all stages of a chained future.
  *
  * @return [Cassandra::Future] self.
  */
@@ -339,21 +916,298 @@ static VALUE future_await(VALUE self)
 
     GET_FUTURE(self, cassandra_future);
 
-    rb_mutex_lock(cassandra_future->proc_mutex);
-    if (cassandra_future->already_waited) {
-        rb_mutex_unlock(cassandra_future->proc_mutex);
+    if (cassandra_future->kind == chain_async) {
+        future_chain_await(self);
+        // Run the callbacks here if the completion path has not yet, or wait
+        // for it to finish running them.
+        future_yield(self);
         return self;
     }
-    cassandra_future->already_waited = true;
-    rb_mutex_unlock(cassandra_future->proc_mutex);
 
-    nogvl_future_wait(cassandra_future->future);
-    if (cassandra_future->on_success_block || cassandra_future->on_failure_block) {
-        nogvl_sem_wait(&cassandra_future->sem);
+    if (!future_state_set(cassandra_future, FUTURE_WAITED)) {
+        return self;
+    }
+
+    future_wait(self, cassandra_future);
+    if (cassandra_future->proc_mutex) {
+        // Run the callback here if the dispatcher has not reached it yet, or
+        // wait on the mutex for the dispatcher to finish running it. Never
+        // waiting for the dispatcher itself lets callbacks await other futures.
+        rb_mutex_synchronize(cassandra_future->proc_mutex, future_result_yielder_synchronize, self);
     }
     return self;
 }
 
+/**
+ * Waits for the future and returns its value.
+ *
+ * @return [Cassandra::Statement, Cassandra::Result, Object] The value: a statement for +Cassandra::Session#prepare_async+, a result for +Cassandra::Session#execute_async+, or the value of a chained future.
+ * @raise [Cassandra::ExecutionError] If the statement failed.
+ * @raise [StandardError] The error of a failed chained future.
+ */
+static VALUE future_value_get(VALUE self)
+{
+    CassandraFuture *cassandra_future;
+
+    future_await(self);
+    GET_FUTURE(self, cassandra_future);
+    if (cassandra_future->kind != chain_async) {
+        // In case another thread is still awaiting it.
+        future_wait(self, cassandra_future);
+    }
+
+    if (future_failed(cassandra_future)) {
+        rb_exc_raise(future_error(cassandra_future));
+    }
+    return future_value(cassandra_future);
+}
+
+static void *future_wait_many_cb(void *ptr)
+{
+    future_waiter *waiter = (future_waiter *)ptr;
+
+    uv_mutex_lock(&waiter->lock);
+    // Checked under the lock, so that no driver callback can fire between
+    // the check and the wait without waking it.
+    while (!waiter->interrupted) {
+        if (waiter->completed >= waiter->needed) {
+            waiter->done = true;
+            break;
+        }
+        if (waiter->deadline) {
+            uint64_t now = uv_hrtime();
+
+            if (now >= waiter->deadline) {
+                break;
+            }
+            uv_cond_timedwait(&waiter->cond, &waiter->lock, waiter->deadline - now);
+        } else {
+            uv_cond_wait(&waiter->cond, &waiter->lock);
+        }
+    }
+    uv_mutex_unlock(&waiter->lock);
+    return NULL;
+}
+
+static void future_wait_many_ubf(void *ptr)
+{
+    future_waiter *waiter = (future_waiter *)ptr;
+
+    uv_mutex_lock(&waiter->lock);
+    waiter->interrupted = true;
+    uv_cond_signal(&waiter->cond);
+    uv_mutex_unlock(&waiter->lock);
+}
+
+/*
+ * Links the waiter from the future to wait for to complete the given one,
+ * whose driver callback then counts it. Returns false without linking if
+ * that future is already complete.
+ */
+static bool future_wait_many_link(VALUE future, future_waiter *waiter, future_waiter_link *link)
+{
+    CassandraFuture *cassandra_future;
+    future_waiter_link *head;
+
+    GET_FUTURE(future, cassandra_future);
+    if (cassandra_future->kind == chain_async) {
+        future = future_chain_pending(future);
+        if (NIL_P(future)) {
+            return false;
+        }
+        GET_FUTURE(future, cassandra_future);
+    }
+    if (cass_future_ready(cassandra_future->future) == cass_true) {
+        return false;
+    }
+    if (future_state_set(cassandra_future, FUTURE_REGISTERED)) {
+        future_completion_register(future);
+    }
+
+    link->waiter = waiter;
+    RUBY_ATOMIC_INC(waiter->refcount);
+    do {
+        head = cassandra_future->waiters;
+        if (head == FUTURE_WAITERS_DONE) {
+            // The callback fired since the check above.
+            RUBY_ATOMIC_DEC(waiter->refcount);
+            return false;
+        }
+        link->next = head;
+    } while (RUBY_ATOMIC_PTR_CAS(cassandra_future->waiters, head, link) != head);
+    return true;
+}
+
+static VALUE future_wait_many_block(VALUE ptr)
+{
+    future_wait_many *wait = (future_wait_many *)ptr;
+    future_waiter *waiter = wait->waiter;
+    size_t pending = 0;
+
+    for (long i = 0; i < RARRAY_LEN(wait->futures); i++) {
+        if (future_wait_many_link(RARRAY_AREF(wait->futures, i), waiter, &waiter->links[i])) {
+            pending++;
+        } else if (wait->any) {
+            pending = 0;
+            break;
+        }
+    }
+    uv_mutex_lock(&waiter->lock);
+    waiter->needed = wait->any ? (pending > 0 ? 1 : 0) : pending;
+    uv_mutex_unlock(&waiter->lock);
+
+    while (1) {
+        rb_thread_call_without_gvl(future_wait_many_cb, waiter, future_wait_many_ubf, waiter);
+        if (waiter->done || !waiter->interrupted) {
+            break;
+        }
+        waiter->interrupted = false;
+        rb_thread_check_ints();
+    }
+    wait->done = waiter->done;
+    return Qnil;
+}
+
+static VALUE future_wait_many_release(VALUE ptr)
+{
+    future_waiter_release((future_waiter *)ptr);
+    return Qnil;
+}
+
+/*
+ * Blocks without the GVL until all or any of the futures are complete, or
+ * the timeout elapsed. Returns whether they are.
+ */
+static bool future_wait_many_await(VALUE futures, bool any, VALUE options)
+{
+    static ID keywords[1];
+    future_wait_many wait;
+    VALUE timeout = Qundef;
+    uint64_t deadline = 0;
+    long count = RARRAY_LEN(futures);
+    bool done = false;
+
+    if (!keywords[0]) {
+        keywords[0] = rb_intern("timeout");
+    }
+    if (!NIL_P(options)) {
+        rb_get_kwargs(options, keywords, 0, 1, &timeout);
+    }
+    if (timeout != Qundef && !NIL_P(timeout)) {
+        double seconds = NUM2DBL(timeout);
+
+        if (seconds < 0) {
+            rb_raise(rb_eArgError, "Invalid timeout: %"PRIsVALUE"", timeout);
+        }
+        deadline = uv_hrtime() + (uint64_t)(seconds * 1e9) + 1;
+    }
+
+    wait.futures = futures;
+    wait.any = any;
+    while (count > 0) {
+        future_waiter *waiter;
+        bool complete = !any;
+
+        // A fresh waiter per round: links of the previous one may still be
+        // notified by futures which were not complete yet.
+        waiter = malloc(sizeof(future_waiter) + sizeof(future_waiter_link) * (size_t)count);
+        if (waiter == NULL) {
+            rb_memerror();
+        }
+        uv_mutex_init(&waiter->lock);
+        uv_cond_init(&waiter->cond);
+        waiter->refcount = 1;
+        // Callbacks firing while the futures are linked must not signal.
+        waiter->needed = SIZE_MAX;
+        waiter->completed = 0;
+        waiter->deadline = deadline;
+        waiter->done = false;
+        waiter->interrupted = false;
+
+        wait.waiter = waiter;
+        wait.done = false;
+        rb_ensure(future_wait_many_block, (VALUE)&wait, future_wait_many_release, (VALUE)waiter);
+        done = wait.done;
+        ilios_memory_fold();
+        if (!done) {
+            break;
+        }
+
+        // A chained future whose request finished may have submitted the next.
+        for (long i = 0; i < count; i++) {
+            CassandraFuture *cassandra_future;
+
+            GET_FUTURE(RARRAY_AREF(futures, i), cassandra_future);
+            if (future_complete(cassandra_future) == any) {
+                complete = any;
+                break;
+            }
+        }
+        if (complete) {
+            break;
+        }
+    }
+    RB_GC_GUARD(futures);
+
+    return count > 0 ? done : !any;
+}
+
+/**
+ * Waits until all of the futures are complete, blocking the thread only
+ * once, and then runs their callbacks like {#await}.
+ *
+ * @param futures [Array<Cassandra::Future>] The futures.
+ * @param timeout [Float, nil] The maximum number of seconds to wait. The default is to wait until they are complete.
+ * @return [Array<Cassandra::Future>, nil] The futures, or +nil+ if the timeout elapsed first.
+ * @raise [TypeError] If something other than futures was given.
+ */
+static VALUE future_s_await_all(int argc, VALUE *argv, VALUE klass)
+{
+    VALUE futures, options;
+
+    rb_scan_args(argc, argv, "1:", &futures, &options);
+    futures = rb_ary_dup(rb_convert_type(futures, T_ARRAY, "Array", "to_ary"));
+
+    if (!future_wait_many_await(futures, false, options)) {
+        return Qnil;
+    }
+    for (long i = 0; i < RARRAY_LEN(futures); i++) {
+        future_await(RARRAY_AREF(futures, i));
+    }
+    return futures;
+}
+
+/**
+ * Waits until any of the futures is complete, blocking the thread only
+ * once, and then runs its callbacks like {#await}.
+ *
+ * @param futures [Array<Cassandra::Future>] The futures.
+ * @param timeout [Float, nil] The maximum number of seconds to wait. The default is to wait until one is complete.
+ * @return [Cassandra::Future, nil] The first complete future in the given order, or +nil+ if the timeout elapsed first or no futures were given.
+ * @raise [TypeError] If something other than futures was given.
+ */
+static VALUE future_s_await_any(int argc, VALUE *argv, VALUE klass)
+{
+    VALUE futures, options;
+    long index;
+
+    rb_scan_args(argc, argv, "1:", &futures, &options);
+    futures = rb_ary_dup(rb_convert_type(futures, T_ARRAY, "Array", "to_ary"));
+
+    if (!future_wait_many_await(futures, true, options)) {
+        return Qnil;
+    }
+    for (index = 0; index < RARRAY_LEN(futures); index++) {
+        CassandraFuture *cassandra_future;
+
+        GET_FUTURE(RARRAY_AREF(futures, index), cassandra_future);
+        if (future_complete(cassandra_future)) {
+            break;
+        }
+    }
+    return future_await(RARRAY_AREF(futures, index));
+}
+
 static void future_mark(void *ptr)
 {
     CassandraFuture *cassandra_future = (CassandraFuture *)ptr;
@@ -362,6 +1216,12 @@ static void future_mark(void *ptr)
     rb_gc_mark_movable(cassandra_future->on_success_block);
     rb_gc_mark_movable(cassandra_future->on_failure_block);
     rb_gc_mark_movable(cassandra_future->proc_mutex);
+    rb_gc_mark_movable(cassandra_future->completion_queue_obj);
+    rb_gc_mark_movable(cassandra_future->value);
+    rb_gc_mark_movable(cassandra_future->error);
+    rb_gc_mark_movable(cassandra_future->dependents);
+    rb_gc_mark_movable(cassandra_future->source_obj);
+    rb_gc_mark_movable(cassandra_future->chain_block);
 }
 
 static void future_destroy(void *ptr)
@@ -376,34 +1236,65 @@ static void future_destroy(void *ptr)
         // holds its own reference to the statement internals.
         cass_statement_free(cassandra_future->executed_statement);
     }
-    uv_sem_destroy(&cassandra_future->sem);
+
+    uv_mutex_lock(&future_pool.lock);
+    if (future_pool.count < FUTURE_POOL_SIZE) {
+        cassandra_future->completion_next = future_pool.head;
+        future_pool.head = cassandra_future;
+        future_pool.count++;
+        cassandra_future = NULL;
+    }
+    uv_mutex_unlock(&future_pool.lock);
     xfree(cassandra_future);
 }
 
 static size_t future_memsize(const void *ptr)
 {
-    return sizeof(CassandraFuture);
+    const CassandraFuture *cassandra_future = (const CassandraFuture *)ptr;
+    size_t size = sizeof(CassandraFuture);
+
+    if (cassandra_future->executed_statement) {
+        size += statement_bound_size(cassandra_future->statement_obj);
+    }
+    // The response retained until a result takes it over is left out: sizing
+    // it means walking the page, too slow for a memsize callback. The result
+    // reports it once created.
+    return size;
 }
 
 static void future_compact(void *ptr)
 {
     CassandraFuture *cassandra_future = (CassandraFuture *)ptr;
 
+    cassandra_future->future_obj = rb_gc_location(cassandra_future->future_obj);
     cassandra_future->session_obj = rb_gc_location(cassandra_future->session_obj);
     cassandra_future->statement_obj = rb_gc_location(cassandra_future->statement_obj);
     cassandra_future->on_success_block = rb_gc_location(cassandra_future->on_success_block);
     cassandra_future->on_failure_block = rb_gc_location(cassandra_future->on_failure_block);
     cassandra_future->proc_mutex = rb_gc_location(cassandra_future->proc_mutex);
+    cassandra_future->completion_queue_obj = rb_gc_location(cassandra_future->completion_queue_obj);
+    cassandra_future->value = rb_gc_location(cassandra_future->value);
+    cassandra_future->error = rb_gc_location(cassandra_future->error);
+    cassandra_future->dependents = rb_gc_location(cassandra_future->dependents);
+    cassandra_future->source_obj = rb_gc_location(cassandra_future->source_obj);
+    cassandra_future->chain_block = rb_gc_location(cassandra_future->chain_block);
 }
 
 void Init_future(void)
 {
     rb_undef_alloc_func(cFuture);
 
+    rb_define_singleton_method(cFuture, "await_all", future_s_await_all, -1);
+    rb_define_singleton_method(cFuture, "await_any", future_s_await_any, -1);
+
     rb_define_method(cFuture, "on_success", future_on_success, 0);
     rb_define_method(cFuture, "on_failure", future_on_failure, 0);
     rb_define_method(cFuture, "await", future_await, 0);
+    rb_define_method(cFuture, "value", future_value_get, 0);
+    rb_define_method(cFuture, "then", future_then, 0);
+    rb_define_method(cFuture, "map", future_map, 0);
+    rb_define_method(cFuture, "rescue", future_rescue, 0);
 
-    future_thread_pool_init(&thread_pool_prepare);
-    future_thread_pool_init(&thread_pool_execute);
+    future_completion_queue_init(&completion_queue);
+    uv_mutex_init(&future_pool.lock);
 }
@@ -7,59 +7,252 @@ VALUE cSession;
 VALUE cStatement;
 VALUE cResult;
 VALUE cFuture;
+VALUE cBatch;
+VALUE cRow;
+VALUE cCompletionQueue;
 VALUE eConnectError;
 VALUE eExecutionError;
 VALUE eStatementError;
 
-VALUE cSizedQueue;
-
 VALUE id_to_time;
-VALUE id_new;
-VALUE id_push;
-VALUE id_pop;
 VALUE id_alive;
 VALUE id_report_on_exception;
+VALUE id_full_message;
+VALUE id_each;
+VALUE id_new;
+VALUE id_owned;
+VALUE id_thread_variable_get;
+VALUE id_thread_variable_set;
 VALUE sym_unsupported_column_type;
 
-#if defined(HAVE_MALLOC_USABLE_SIZE)
-#include <malloc.h>
-#elif defined(HAVE_MALLOC_SIZE)
-#include <malloc/malloc.h>
+/*
+ * Driver allocations mostly happen on its IO threads, which must not call
+ * into Ruby. Each thread counts them in its own slot, padded to a cache line
+ * and written only by that thread, so that counting needs neither atomics nor
+ * shared cache lines. ilios_memory_fold sums the slots and reports the net
+ * change to the GC from Ruby threads.
+ */
+#define MEMORY_SLOT_SIZE 64
+
+typedef struct memory_slot
+{
+    union
+    {
+        struct
+        {
+            // Net bytes allocated by the thread, wrapping around when it
+            // freed more than it allocated. Word sized stores can't tear, so
+            // other threads read a value which is at most slightly stale.
+            volatile size_t bytes;
+            volatile size_t allocations;
+            volatile size_t frees;
+            // Next slot of all the threads which ever used the allocator.
+            struct memory_slot *next;
+            // Next slot of an exited thread, free to be reused.
+            struct memory_slot *next_free;
+        };
+        char padding[MEMORY_SLOT_SIZE];
+    };
+} memory_slot;
+
+static struct
+{
+    uv_mutex_t lock;
+    memory_slot *slots;
+    memory_slot *free_slots;
+    // Releases the slot of an exiting thread.
+    pthread_key_t key;
+    // The bytes reported to the GC so far. Only accessed with the GVL.
+    size_t folded;
+} driver_memory;
+
+#ifdef RB_THREAD_LOCAL_SPECIFIER
+static RB_THREAD_LOCAL_SPECIFIER memory_slot *driver_memory_slot;
+#endif
+
+static void ilios_memory_slot_release(void *ptr)
+{
+    memory_slot *slot = (memory_slot *)ptr;
+
+#ifdef RB_THREAD_LOCAL_SPECIFIER
+    // Runs on the exiting thread, which may still allocate afterwards.
+    driver_memory_slot = NULL;
 #endif
+    // The counts stay in the slot, and are continued by the next thread.
+    uv_mutex_lock(&driver_memory.lock);
+    slot->next_free = driver_memory.free_slots;
+    driver_memory.free_slots = slot;
+    uv_mutex_unlock(&driver_memory.lock);
+}
+
+static memory_slot *ilios_memory_slot_acquire(void)
+{
+    memory_slot *slot;
 
-static ssize_t ilios_malloc_size(void *ptr)
+    uv_mutex_lock(&driver_memory.lock);
+    slot = driver_memory.free_slots;
+    if (slot) {
+        driver_memory.free_slots = slot->next_free;
+    } else if (posix_memalign((void **)&slot, MEMORY_SLOT_SIZE, sizeof(memory_slot)) == 0) {
+        memset(slot, 0, sizeof(memory_slot));
+        slot->next = driver_memory.slots;
+        // Published last, as readers walk the list without the lock.
+        RUBY_ATOMIC_PTR_EXCHANGE(driver_memory.slots, slot);
+    } else {
+        slot = NULL;
+    }
+    uv_mutex_unlock(&driver_memory.lock);
+
+    if (slot) {
+        pthread_setspecific(driver_memory.key, slot);
+    }
+    return slot;
+}
+
+static inline memory_slot *ilios_memory_slot(void)
 {
-#if defined(HAVE_MALLOC_USABLE_SIZE)
-    return malloc_usable_size(ptr);
-#elif defined(HAVE_MALLOC_SIZE)
-    return malloc_size(ptr);
+    memory_slot *slot;
+
+#ifdef RB_THREAD_LOCAL_SPECIFIER
+    slot = driver_memory_slot;
+    if (slot == NULL) {
+        slot = driver_memory_slot = ilios_memory_slot_acquire();
+    }
 #else
-    return 0;
+    slot = (memory_slot *)pthread_getspecific(driver_memory.key);
+    if (slot == NULL) {
+        slot = ilios_memory_slot_acquire();
+    }
 #endif
+    return slot;
 }
 
+/*
+ * Every driver block is prefixed by its requested size, so that freeing it
+ * needs no query to the allocator. The header keeps the block aligned for
+ * any type.
+ */
+typedef union
+{
+    size_t size;
+    long double align_float;
+    long long align_integer;
+    void *align_pointer;
+} memory_header;
+
 static void *ilios_malloc(size_t size)
 {
-    rb_gc_adjust_memory_usage(size);
-    return malloc(size);
+    memory_header *header;
+
+    if (size > SIZE_MAX - sizeof(memory_header)) {
+        return NULL;
+    }
+    header = malloc(sizeof(memory_header) + size);
+    if (header == NULL) {
+        return NULL;
+    }
+    header->size = size;
+
+    {
+        memory_slot *slot = ilios_memory_slot();
+
+        if (slot) {
+            slot->bytes += size;
+            slot->allocations++;
+        }
+    }
+    return header + 1;
 }
 
 static void *ilios_realloc(void *ptr, size_t size)
 {
-    ssize_t before_size = ilios_malloc_size(ptr);
-    rb_gc_adjust_memory_usage(size - before_size);
-    return realloc(ptr, size);
+    memory_header *header;
+    size_t before_size;
+
+    if (ptr == NULL) {
+        return ilios_malloc(size);
+    }
+    if (size > SIZE_MAX - sizeof(memory_header)) {
+        return NULL;
+    }
+    header = (memory_header *)ptr - 1;
+    before_size = header->size;
+    header = realloc(header, sizeof(memory_header) + size);
+    if (header == NULL) {
+        return NULL;
+    }
+    header->size = size;
+
+    {
+        memory_slot *slot = ilios_memory_slot();
+
+        if (slot) {
+            slot->bytes += size - before_size;
+        }
+    }
+    return header + 1;
 }
 
 static void ilios_free(void *ptr)
 {
     if (ptr) {
-        ssize_t size = ilios_malloc_size(ptr);
-        rb_gc_adjust_memory_usage(-size);
-        free(ptr);
+        memory_header *header = (memory_header *)ptr - 1;
+        memory_slot *slot = ilios_memory_slot();
+
+        if (slot) {
+            slot->bytes -= header->size;
+            slot->frees++;
+        }
+        free(header);
+    }
+}
+
+/*
+ * Reports the driver's allocations since the last call to the GC. Must be
+ * called with the GVL, e.g. right after waiting on the driver.
+ */
+void ilios_memory_fold(void)
+{
+    memory_slot *slot = RUBY_ATOMIC_PTR_LOAD(driver_memory.slots);
+    size_t bytes = 0;
+    ssize_t diff;
+
+    for (; slot; slot = slot->next) {
+        bytes += slot->bytes;
+    }
+    diff = (ssize_t)(bytes - driver_memory.folded);
+    if (diff != 0) {
+        driver_memory.folded = bytes;
+        rb_gc_adjust_memory_usage(diff);
     }
 }
 
+/**
+ * Returns statistics of the memory allocated by the Cassandra driver.
+ * Allocations are reported to the GC when Ruby threads wait on the driver,
+ * and when this is called.
+ *
+ * @return [Hash] +:allocated_bytes+, the bytes currently allocated,
+ *   +:allocations+ and +:frees+, the number of allocations and frees so far.
+ */
+static VALUE cassandra_driver_memory_stats(VALUE self)
+{
+    memory_slot *slot = RUBY_ATOMIC_PTR_LOAD(driver_memory.slots);
+    size_t allocations = 0;
+    size_t frees = 0;
+    VALUE stats = rb_hash_new();
+
+    ilios_memory_fold();
+    for (; slot; slot = slot->next) {
+        allocations += slot->allocations;
+        frees += slot->frees;
+    }
+    rb_hash_aset(stats, ID2SYM(rb_intern("allocated_bytes")), SIZET2NUM(driver_memory.folded));
+    rb_hash_aset(stats, ID2SYM(rb_intern("allocations")), SIZET2NUM(allocations));
+    rb_hash_aset(stats, ID2SYM(rb_intern("frees")), SIZET2NUM(frees));
+    return stats;
+}
+
 /**
  *  Sets the log level.
  * Default is +LOG_ERROR+.
@@ -74,6 +267,12 @@ static VALUE cassandra_set_log_level(VALUE self, VALUE log_level)
 
 void Init_ilios(void)
 {
+    // Before any other driver call, as blocks allocated by the driver's own
+    // allocator can't be freed by ilios_free.
+    uv_mutex_init(&driver_memory.lock);
+    pthread_key_create(&driver_memory.key, ilios_memory_slot_release);
+    cass_alloc_set_functions(ilios_malloc, ilios_realloc, ilios_free);
+
     rb_ext_ractor_safe(true);
 
     mIlios = rb_define_module("Ilios");
@@ -83,21 +282,26 @@ void Init_ilios(void)
     cStatement = rb_define_class_under(mCassandra, "Statement", rb_cObject);
     cResult = rb_define_class_under(mCassandra, "Result", rb_cObject);
     cFuture = rb_define_class_under(mCassandra, "Future", rb_cObject);
+    cBatch = rb_define_class_under(mCassandra, "Batch", rb_cObject);
+    cRow = rb_define_class_under(mCassandra, "Row", rb_cObject);
+    cCompletionQueue = rb_define_class_under(mCassandra, "CompletionQueue", rb_cObject);
     eConnectError = rb_define_class_under(mCassandra, "ConnectError", rb_eStandardError);
     eExecutionError = rb_define_class_under(mCassandra, "ExecutionError", rb_eStandardError);
     eStatementError = rb_define_class_under(mCassandra, "StatementError", rb_eStandardError);
 
-    cSizedQueue = rb_const_get(rb_cThread, rb_intern("SizedQueue"));
-
     id_to_time = rb_intern("to_time");
-    id_new = rb_intern("new");
-    id_push = rb_intern("push");
-    id_pop = rb_intern("pop");
     id_alive = rb_intern("alive?");
     id_report_on_exception = rb_intern("report_on_exception=");
+    id_full_message = rb_intern("full_message");
+    id_each = rb_intern("each");
+    id_new = rb_intern("new");
+    id_owned = rb_intern("owned?");
+    id_thread_variable_get = rb_intern("thread_variable_get");
+    id_thread_variable_set = rb_intern("thread_variable_set");
     sym_unsupported_column_type = ID2SYM(rb_intern("unsupported_column_type"));
 
     rb_define_module_function(mCassandra, "log_level", cassandra_set_log_level, 1);
+    rb_define_module_function(mCassandra, "driver_memory_stats", cassandra_driver_memory_stats, 0);
     rb_define_const(mCassandra, "LOG_DISABLED", INT2NUM(CASS_LOG_DISABLED));
     rb_define_const(mCassandra, "LOG_CRITICAL", INT2NUM(CASS_LOG_CRITICAL));
     rb_define_const(mCassandra, "LOG_ERROR", INT2NUM(CASS_LOG_ERROR));
@@ -105,16 +309,27 @@ void Init_ilios(void)
     rb_define_const(mCassandra, "LOG_INFO", INT2NUM(CASS_LOG_INFO));
     rb_define_const(mCassandra, "LOG_DEBUG", INT2NUM(CASS_LOG_DEBUG));
     rb_define_const(mCassandra, "LOG_TRACE", INT2NUM(CASS_LOG_TRACE));
+    rb_define_const(mCassandra, "CONSISTENCY_ANY", INT2NUM(CASS_CONSISTENCY_ANY));
+    rb_define_const(mCassandra, "CONSISTENCY_ONE", INT2NUM(CASS_CONSISTENCY_ONE));
+    rb_define_const(mCassandra, "CONSISTENCY_TWO", INT2NUM(CASS_CONSISTENCY_TWO));
+    rb_define_const(mCassandra, "CONSISTENCY_THREE", INT2NUM(CASS_CONSISTENCY_THREE));
+    rb_define_const(mCassandra, "CONSISTENCY_QUORUM", INT2NUM(CASS_CONSISTENCY_QUORUM));
+    rb_define_const(mCassandra, "CONSISTENCY_ALL", INT2NUM(CASS_CONSISTENCY_ALL));
+    rb_define_const(mCassandra, "CONSISTENCY_LOCAL_QUORUM", INT2NUM(CASS_CONSISTENCY_LOCAL_QUORUM));
+    rb_define_const(mCassandra, "CONSISTENCY_EACH_QUORUM", INT2NUM(CASS_CONSISTENCY_EACH_QUORUM));
+    rb_define_const(mCassandra, "CONSISTENCY_SERIAL", INT2NUM(CASS_CONSISTENCY_SERIAL));
+    rb_define_const(mCassandra, "CONSISTENCY_LOCAL_SERIAL", INT2NUM(CASS_CONSISTENCY_LOCAL_SERIAL));
+    rb_define_const(mCassandra, "CONSISTENCY_LOCAL_ONE", INT2NUM(CASS_CONSISTENCY_LOCAL_ONE));
 
     Init_cluster();
     Init_session();
     Init_statement();
     Init_result();
     Init_future();
+    Init_batch();
+    Init_bulk_load();
+    Init_row();
+    Init_completion_queue();
 
     cass_log_set_level(CASS_LOG_ERROR);
-
-#if defined(HAVE_MALLOC_USABLE_SIZE) || defined(HAVE_MALLOC_SIZE)
-    cass_alloc_set_functions(ilios_malloc, ilios_realloc, ilios_free);
-#endif
 }
@@ -6,8 +6,19 @@
 #include <cassandra.h>
 #include <uv.h>
 #include "ruby.h"
+#include "ruby/atomic.h"
 #include "ruby/thread.h"
 #include "ruby/encoding.h"
+#if defined(HAVE_RB_IO_BUFFER_GET_BYTES_FOR_READING) || defined(HAVE_RB_IO_BUFFER_GET_BYTES_FOR_WRITING) || defined(HAVE_RB_IO_BUFFER_NEW)
+#include "ruby/io/buffer.h"
+#endif
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "ruby/io.h"
+#ifdef HAVE_RB_FIBER_SCHEDULER_CURRENT
+#include "ruby/fiber/scheduler.h"
+#endif
 
 #define DEFAULT_PAGE_SIZE 10000
 
@@ -16,23 +27,88 @@
 #define GET_STATEMENT(obj, var) TypedData_Get_Struct(obj, CassandraStatement, &cassandra_statement_data_type, var)
 #define GET_RESULT(obj, var)    TypedData_Get_Struct(obj, CassandraResult, &cassandra_result_data_type, var)
 #define GET_FUTURE(obj, var)    TypedData_Get_Struct(obj, CassandraFuture, &cassandra_future_data_type, var)
+#define GET_BATCH(obj, var)     TypedData_Get_Struct(obj, CassandraBatch, &cassandra_batch_data_type, var)
+#define GET_ROW(obj, var)       TypedData_Get_Struct(obj, CassandraRow, &cassandra_row_data_type, var)
+#define GET_COMPLETION_QUEUE(obj, var) TypedData_Get_Struct(obj, CassandraCompletionQueue, &cassandra_completion_queue_data_type, var)
 #define CREATE_CLUSTER(var)     TypedData_Make_Struct(cCluster, CassandraCluster, &cassandra_cluster_data_type, var)
 #define CREATE_SESSION(var)     TypedData_Make_Struct(cSession, CassandraSession, &cassandra_session_data_type, var)
 #define CREATE_STATEMENT(var)   TypedData_Make_Struct(cStatement, CassandraStatement, &cassandra_statement_data_type, var)
 #define CREATE_RESULT(var)      TypedData_Make_Struct(cResult, CassandraResult, &cassandra_result_data_type, var)
-#define CREATE_FUTURE(var)      TypedData_Make_Struct(cFuture, CassandraFuture, &cassandra_future_data_type, var)
+#define CREATE_BATCH(var)       TypedData_Make_Struct(cBatch, CassandraBatch, &cassandra_batch_data_type, var)
+#define CREATE_ROW(var)         TypedData_Make_Struct(cRow, CassandraRow, &cassandra_row_data_type, var)
 
 typedef enum {
   prepare_async,
-  execute_async
+  execute_async,
+  // Created by Future#then, #map or #rescue, without a CassFuture.
+  chain_async
 } future_kind;
 
+typedef enum {
+  future_chain_then,
+  future_chain_map,
+  future_chain_rescue,
+  // The block of a then or rescue stage returned a future, which the chain
+  // now follows.
+  future_chain_adopt
+} future_chain_stage;
+
 typedef enum {
   idempotency_unset,
   idempotency_false,
   idempotency_true
 } statement_idempotency;
 
+typedef enum {
+  statement_value_unset,
+  statement_value_null,
+  statement_value_set
+} statement_value_state;
+
+typedef struct
+{
+    statement_value_state state;
+    union
+    {
+        cass_int64_t integer;
+        cass_double_t floating;
+        cass_bool_t boolean;
+        CassUuid uuid;
+    } as;
+    // The Ruby object holding the value's bytes (a frozen String), or 0.
+    VALUE object;
+} statement_value;
+
+typedef struct
+{
+    // Values are shared by the statements created with Statement#bind_new
+    // until one of them binds a value (copy-on-write).
+    rb_atomic_t refcount;
+    size_t count;
+    statement_value values[];
+} statement_values;
+
+typedef struct statement_parameter statement_parameter;
+typedef void (*statement_encode_func)(const statement_parameter *parameter, VALUE value, statement_value *encoded);
+typedef CassError (*statement_apply_func)(CassStatement *statement, size_t index, const statement_value *encoded);
+
+struct statement_parameter
+{
+    size_t index;
+    // Points into the CassPrepared's metadata, not NUL-terminated.
+    const char *name;
+    size_t name_length;
+    VALUE symbol;
+    CassValueType type;
+    // Converts a Ruby value once when it is bound.
+    statement_encode_func encode;
+    // Binds an encoded value to the CassStatement of an execution.
+    statement_apply_func apply;
+    // Index of the first parameter with the same name, and the next one.
+    size_t first;
+    struct statement_parameter *next;
+};
+
 typedef struct
 {
     CassCluster* cluster;
@@ -46,30 +122,156 @@ typedef struct
 
 typedef struct
 {
-    // Scratch statement used for validating values in Statement#bind.
-    // It is never handed to the driver: each execution gets its own
-    // CassStatement built from `prepared` and `bound_values`, because the
-    // driver encodes values asynchronously on its IO thread and re-binding
-    // an in-flight statement is a use-after-free (issue #12).
-    CassStatement* statement;
+    // Each execution gets its own CassStatement built from `prepared` and
+    // `bound_values`, because the driver encodes values asynchronously on its
+    // IO thread and re-binding an in-flight statement is a use-after-free
+    // (issue #12).
     const CassPrepared* prepared;
+    // The Statement owning `prepared` when it is borrowed (Statement#bind_new).
+    VALUE prepared_obj;
+    // Parameters of `prepared` by index, built once when the query is prepared.
+    // NULL for borrowed statements, which use those of `prepared_obj`.
+    statement_parameter *parameters;
+    size_t parameter_count;
     VALUE session_obj;
-    VALUE bound_values;
+    // Values bound to each parameter index, or NULL if nothing was bound yet.
+    statement_values *bound_values;
     int page_size;
     statement_idempotency idempotent;
+    // Frozen binary String from Result#paging_state, or 0 to start from the first page.
+    VALUE paging_state;
 } CassandraStatement;
 
 typedef struct
+{
+    CassBatchType type;
+    // Statements made by Statement#bind_new, one per Batch#add.
+    VALUE statements;
+    // CASS_CONSISTENCY_UNKNOWN until set, to keep the cluster's default.
+    CassConsistency consistency;
+    statement_idempotency idempotent;
+} CassandraBatch;
+
+typedef struct
+{
+    CassError error;
+    bool null;
+    union {
+        cass_int64_t integer;
+        cass_double_t floating;
+        cass_bool_t boolean;
+        CassUuid uuid;
+        // Points into the CassResult.
+        struct {
+            const char *ptr;
+            size_t length;
+        } bytes;
+    } as;
+} result_cell;
+
+typedef struct result_column result_column;
+typedef struct CassandraResult CassandraResult;
+typedef VALUE (*result_decode_func)(const CassValue *value, const result_column *column);
+typedef void (*result_extract_func)(const CassValue *value, result_cell *cell);
+typedef VALUE (*result_materialize_func)(const result_column *column, const result_cell *cell);
+
+struct result_column
+{
+    // Interned column name, used as the row Hash key.
+    VALUE key;
+    CassValueType type;
+    // Converts a non-null cell of this column to a Ruby object.
+    result_decode_func decode;
+    // The same in two steps: extracting the cell into native memory, which
+    // needs no GVL, then converting that to a Ruby object.
+    result_extract_func extract;
+    result_materialize_func materialize;
+    // For text and blob columns of a result with a view threshold, the
+    // result to make IO::Buffer views into. NULL to always copy.
+    CassandraResult *views;
+};
+
+// A CassResult shared with the IO::Buffer views into it, freed when the
+// result has moved on from it and no view is left.
+typedef struct
+{
+    const CassResult *result;
+    rb_atomic_t refcount;
+} result_page;
+
+struct CassandraResult
 {
     const CassResult *result;
     CassFuture *future;
+    // Decoder plan, built once on first iteration and kept across pages.
+    result_column *columns;
+    size_t column_count;
+    // Struct class for rows of the plan, created on first use, or 0.
+    VALUE struct_class;
     // The CassStatement this result was executed with (owned, freed on destroy).
-    // Not to be confused with statement_obj, the Ruby Statement object.
+    // Not to be confused with statement_obj, the Ruby Statement object
+    // (or Batch object, in which case executed_statement is NULL).
     CassStatement *executed_statement;
     VALUE statement_obj;
-} CassandraResult;
+    // Set while each_page/each_all drive the paging.
+    bool prefetching;
+    // Number of iterations walking the current page, which must not be
+    // freed meanwhile.
+    size_t iterating;
+    // Incremented whenever the page is replaced, so that lazy rows can tell
+    // their cells no longer point into the current CassResult.
+    size_t page;
+    // Text and blob cells of at least this many bytes are decoded as views
+    // into the CassResult, if not 0.
+    size_t view_threshold;
+    // Set once a view into the current page was made, and then owns it.
+    result_page *shared_page;
+    // Estimated memory retained by the current page, computed on the first
+    // memsize call for it, or 0.
+    size_t page_size;
+};
 
 typedef struct
+{
+    VALUE result_obj;
+    // The result's page this row was read from.
+    size_t page;
+    size_t column_count;
+    // Cells extracted from the page, pointing into its CassResult.
+    result_cell *cells;
+    // Decoded values, Qundef until first accessed.
+    VALUE *values;
+} CassandraRow;
+
+typedef struct nogvl_fiber_signal nogvl_fiber_signal;
+
+// Marks the signal list of a future whose driver callback already fired.
+#define NOGVL_FIBER_SIGNALS_DONE ((nogvl_fiber_signal *)1)
+
+// Entry in a future's list of Future.await_all and Future.await_any calls
+// waiting for it (see future.c).
+typedef struct future_waiter_link
+{
+    struct future_waiter *waiter;
+    struct future_waiter_link *next;
+} future_waiter_link;
+
+/*
+ * Lock-free LIFO of futures whose driver callback has fired. It is pushed
+ * from the driver's IO threads and taken as a whole under the GVL, either by
+ * the internal dispatcher thread or by CompletionQueue#drain (see future.c).
+ */
+typedef struct future_completion_queue
+{
+    struct CassandraFuture *head;
+    // Write end of a CompletionQueue's pipe, signalled when the queue becomes
+    // non-empty. -1 for the internal queue, whose dispatcher waits on sem.
+    int notify_fd;
+    uv_sem_t sem;
+    VALUE thread;
+} future_completion_queue;
+
+typedef struct CassandraFuture
 {
     CassFuture *future;
     // The CassStatement this future's execution was submitted with (owned,
@@ -78,22 +280,63 @@ typedef struct
     CassStatement *executed_statement;
     future_kind kind;
 
+    // The Ruby Future object wrapping this struct, used by the completion
+    // dispatcher which only gets the struct back from the driver callback.
+    VALUE future_obj;
     VALUE session_obj;
     VALUE statement_obj;
     VALUE on_success_block;
     VALUE on_failure_block;
+    // Serializes callbacks with await. Created with the first callback, so
+    // futures which are only awaited never need one.
     VALUE proc_mutex;
 
-    uv_sem_t sem;
-    bool already_waited;
-    bool yielded;
+    // Next entry in the completion queue, or in the pool of recycled
+    // futures (see future.c).
+    struct CassandraFuture *completion_next;
+    // FUTURE_* flags (see future.c), changed atomically.
+    rb_atomic_t state;
+    // Signals of the fibers awaiting this future under a fiber scheduler,
+    // taken atomically by the completion callback.
+    nogvl_fiber_signal *fiber_signals;
+    // Threads in Future.await_all or Future.await_any waiting for this
+    // future, taken atomically by the completion callback.
+    future_waiter_link *waiters;
+    // The CompletionQueue the future is attached to, or NULL for the
+    // internal one.
+    future_completion_queue *completion_queue;
+    VALUE completion_queue_obj;
+
+    // The Statement or Result the future resolved to, created once, or the
+    // value of a chained future.
+    VALUE value;
+    // The exception of a failed chained future.
+    VALUE error;
+    // Chained futures to advance once this one completes (Array or 0).
+    VALUE dependents;
+    // For chained futures: the future the stage runs after, and its block.
+    VALUE source_obj;
+    VALUE chain_block;
+    future_chain_stage chain_stage;
 } CassandraFuture;
 
+typedef struct
+{
+    future_completion_queue queue;
+    // Futures taken from the queue but not drained yet, in completion order.
+    CassandraFuture *ready_head;
+    CassandraFuture *ready_tail;
+    VALUE io;
+} CassandraCompletionQueue;
+
 extern const rb_data_type_t cassandra_cluster_data_type;
 extern const rb_data_type_t cassandra_session_data_type;
 extern const rb_data_type_t cassandra_statement_data_type;
 extern const rb_data_type_t cassandra_result_data_type;
 extern const rb_data_type_t cassandra_future_data_type;
+extern const rb_data_type_t cassandra_batch_data_type;
+extern const rb_data_type_t cassandra_row_data_type;
+extern const rb_data_type_t cassandra_completion_queue_data_type;
 
 extern VALUE mIlios;
 extern VALUE mCassandra;
@@ -102,18 +345,22 @@ extern VALUE cSession;
 extern VALUE cStatement;
 extern VALUE cResult;
 extern VALUE cFuture;
+extern VALUE cBatch;
+extern VALUE cRow;
+extern VALUE cCompletionQueue;
 extern VALUE eConnectError;
 extern VALUE eExecutionError;
 extern VALUE eStatementError;
 
-extern VALUE cSizedQueue;
-
 extern VALUE id_to_time;
-extern VALUE id_new;
-extern VALUE id_push;
-extern VALUE id_pop;
 extern VALUE id_alive;
 extern VALUE id_report_on_exception;
+extern VALUE id_full_message;
+extern VALUE id_each;
+extern VALUE id_new;
+extern VALUE id_owned;
+extern VALUE id_thread_variable_get;
+extern VALUE id_thread_variable_set;
 extern VALUE sym_unsupported_column_type;
 
 extern void Init_cluster(void);
@@ -121,16 +368,47 @@ extern void Init_session(void);
 extern void Init_statement(void);
 extern void Init_result(void);
 extern void Init_future(void);
+extern void Init_batch(void);
+extern void Init_bulk_load(void);
+extern void Init_row(void);
+extern void Init_completion_queue(void);
 
 extern VALUE future_create(CassFuture *future, VALUE session, VALUE statement, future_kind kind);
+extern void future_completion_attach(VALUE future, VALUE queue_obj, future_completion_queue *queue);
+extern CassandraFuture *future_completion_take(future_completion_queue *queue);
+extern void future_completion_release(VALUE future);
+extern VALUE future_completion_dispatch(VALUE future);
+extern void ilios_memory_fold(void);
 extern void nogvl_future_wait(CassFuture *future);
+extern void nogvl_future_wait_local(CassFuture *future);
+extern VALUE nogvl_fiber_scheduler(void);
+#ifdef HAVE_RB_FIBER_SCHEDULER_CURRENT
+extern nogvl_fiber_signal *nogvl_fiber_signal_acquire(VALUE *io);
+extern void nogvl_fiber_signal_release(nogvl_fiber_signal *signal);
+extern bool nogvl_fiber_signal_link(nogvl_fiber_signal **list, nogvl_fiber_signal *signal);
+extern void nogvl_fiber_signal_notify_all(nogvl_fiber_signal **list);
+extern void nogvl_fiber_wait(VALUE scheduler, CassFuture *future, nogvl_fiber_signal *signal, VALUE io, bool owned);
+#endif
 extern CassFuture *nogvl_session_prepare(CassSession* session, VALUE query);
 extern CassFuture *nogvl_session_execute(CassSession* session, CassStatement* statement);
+extern CassFuture *nogvl_session_execute_batch(CassSession* session, CassBatch* batch);
+extern void nogvl_session_execute_many(CassSession* session, CassStatement** statements, CassFuture** futures, size_t count);
+extern void nogvl_future_wait_all(CassFuture **futures, size_t count);
 extern void nogvl_sem_wait(uv_sem_t *sem);
 
 extern void statement_default_config(CassandraStatement *cassandra_statement);
 extern CassStatement *statement_build_for_execution(CassandraStatement *cassandra_statement);
+extern VALUE statement_bind_new(VALUE self, VALUE values);
+extern size_t statement_parameter_index(VALUE self, VALUE name);
+extern void statement_append_value_key(VALUE self, size_t index, VALUE buffer);
+extern size_t statement_bound_size(VALUE statement);
+extern CassBatch *batch_build_for_execution(CassandraBatch *cassandra_batch);
 extern void result_await(CassandraResult *cassandra_result);
+extern void result_load(CassandraResult *cassandra_result);
+extern const result_column *result_columns(VALUE self, CassandraResult *cassandra_result);
+extern void result_set_page(CassandraResult *cassandra_result, const CassResult *result);
+extern size_t result_column_index(const result_column *columns, size_t column_count, VALUE name);
+extern VALUE row_create(VALUE result_obj, CassandraResult *cassandra_result, const CassRow *row);
 
 
 #endif // ILIOS_H
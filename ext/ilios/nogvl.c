@@ -10,6 +10,102 @@ typedef struct {
     CassStatement* statement;
 } nogvl_session_execute_args;
 
+typedef struct {
+    CassSession* session;
+    CassBatch* batch;
+} nogvl_session_execute_batch_args;
+
+typedef struct {
+    CassSession* session;
+    CassStatement** statements;
+    CassFuture** futures;
+    size_t count;
+} nogvl_session_execute_many_args;
+
+typedef struct {
+    CassFuture** futures;
+    size_t count;
+} nogvl_future_wait_all_args;
+
+#ifdef HAVE_RB_FIBER_SCHEDULER_CURRENT
+/*
+ * A pipe the driver's IO thread writes to once a future completes, so that a
+ * fiber can wait for it through the scheduler instead of blocking the thread.
+ * Owned by the pool of the thread which created it, and referenced by the
+ * notifier while waiting: the fiber may stop waiting (e.g. when cancelled)
+ * before the driver calls back.
+ */
+struct nogvl_fiber_signal
+{
+    rb_atomic_t refcount;
+    int write_fd;
+    // Owned by the IO in the pool.
+    int read_fd;
+    // Next signal waiting for the same future.
+    nogvl_fiber_signal *next;
+    // A fiber is waiting on it. Only accessed with the GVL.
+    bool in_use;
+};
+
+/*
+ * Signals of a thread, kept in a thread variable so that awaiting a future
+ * doesn't create a pipe and an IO every time.
+ */
+typedef struct
+{
+    nogvl_fiber_signal **signals;
+    VALUE *ios;
+    size_t count;
+    size_t capa;
+} nogvl_fiber_signal_pool;
+
+static void nogvl_fiber_signal_pool_mark(void *ptr)
+{
+    nogvl_fiber_signal_pool *pool = (nogvl_fiber_signal_pool *)ptr;
+
+    rb_gc_mark_locations(pool->ios, pool->ios + pool->count);
+}
+
+static void nogvl_fiber_signal_pool_free(void *ptr)
+{
+    nogvl_fiber_signal_pool *pool = (nogvl_fiber_signal_pool *)ptr;
+
+    // The read ends are closed by their IOs.
+    for (size_t i = 0; i < pool->count; i++) {
+        nogvl_fiber_signal_release(pool->signals[i]);
+    }
+    xfree(pool->signals);
+    xfree(pool->ios);
+    xfree(pool);
+}
+
+static size_t nogvl_fiber_signal_pool_memsize(const void *ptr)
+{
+    const nogvl_fiber_signal_pool *pool = (const nogvl_fiber_signal_pool *)ptr;
+
+    return sizeof(nogvl_fiber_signal_pool) + pool->capa * (sizeof(nogvl_fiber_signal *) + sizeof(VALUE) + sizeof(nogvl_fiber_signal));
+}
+
+static const rb_data_type_t nogvl_fiber_signal_pool_data_type = {
+    "Ilios::Cassandra::FiberSignalPool",
+    {
+        nogvl_fiber_signal_pool_mark,
+        nogvl_fiber_signal_pool_free,
+        nogvl_fiber_signal_pool_memsize,
+    },
+    0, 0,
+    RUBY_TYPED_FREE_IMMEDIATELY | RUBY_TYPED_WB_PROTECTED,
+};
+
+typedef struct {
+    VALUE scheduler;
+    CassFuture *future;
+    nogvl_fiber_signal *signal;
+    VALUE io;
+    bool owned;
+} nogvl_fiber_wait_args;
+#endif
+
 static void *nogvl_future_wait_cb(void *ptr)
 {
     CassFuture *future = (CassFuture *)ptr;
@@ -17,9 +113,276 @@ static void *nogvl_future_wait_cb(void *ptr)
     return NULL;
 }
 
-void nogvl_future_wait(CassFuture *future)
+/*
+ * Returns the current thread's fiber scheduler, or nil if there is none or
+ * Ruby has no fiber scheduler interface.
+ */
+VALUE nogvl_fiber_scheduler(void)
 {
+#ifdef HAVE_RB_FIBER_SCHEDULER_CURRENT
+    return rb_fiber_scheduler_current();
+#else
+    return Qnil;
+#endif
+}
+
+#ifdef HAVE_RB_FIBER_SCHEDULER_CURRENT
+/*
+ * Returns the current thread's pool of signals, creating it on first use.
+ */
+static VALUE nogvl_fiber_signal_pool_current(void)
+{
+    static ID key;
+    nogvl_fiber_signal_pool *pool;
+    VALUE thread = rb_thread_current();
+    VALUE obj;
+
+    if (!key) {
+        key = rb_intern("ilios_fiber_signals");
+    }
+    obj = rb_funcall(thread, id_thread_variable_get, 1, ID2SYM(key));
+    if (NIL_P(obj)) {
+        obj = TypedData_Make_Struct(rb_cObject, nogvl_fiber_signal_pool, &nogvl_fiber_signal_pool_data_type, pool);
+        rb_funcall(thread, id_thread_variable_set, 2, ID2SYM(key), obj);
+    }
+    return obj;
+}
+
+static nogvl_fiber_signal *nogvl_fiber_signal_create(VALUE *io)
+{
+    nogvl_fiber_signal *signal;
+    int fds[2];
+
+    if (rb_cloexec_pipe(fds) < 0) {
+        rb_sys_fail("pipe");
+    }
+    rb_update_max_fd(fds[1]);
+    // The notifier runs on a driver IO thread which must never block, and
+    // stale bytes are drained before the signal is reused.
+    fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+    fcntl(fds[1], F_SETFL, fcntl(fds[1], F_GETFL) | O_NONBLOCK);
+
+    signal = malloc(sizeof(nogvl_fiber_signal));
+    if (signal == NULL) {
+        close(fds[0]);
+        close(fds[1]);
+        rb_memerror();
+    }
+    signal->refcount = 1;
+    signal->write_fd = fds[1];
+    signal->read_fd = fds[0];
+    signal->next = NULL;
+    signal->in_use = false;
+    *io = rb_io_fdopen(fds[0], O_RDONLY, NULL);
+    return signal;
+}
+
+/*
+ * Takes a signal of the current thread's pool which no fiber is waiting on
+ * and no driver callback will write to anymore, creating one if there is
+ * none. It gets a reference for the notifier, and its IO is returned in io.
+ */
+nogvl_fiber_signal *nogvl_fiber_signal_acquire(VALUE *io)
+{
+    VALUE obj = nogvl_fiber_signal_pool_current();
+    nogvl_fiber_signal_pool *pool = (nogvl_fiber_signal_pool *)RTYPEDDATA_DATA(obj);
+    nogvl_fiber_signal *signal = NULL;
+    char buffer[64];
+
+    for (size_t i = 0; i < pool->count; i++) {
+        // Only the pool's reference is left once the notifier ran.
+        if (!pool->signals[i]->in_use && RUBY_ATOMIC_LOAD(pool->signals[i]->refcount) == 1) {
+            signal = pool->signals[i];
+            *io = pool->ios[i];
+            // Bytes left by a wait which stopped before its future completed.
+            while (read(signal->read_fd, buffer, sizeof(buffer)) > 0) {
+            }
+            break;
+        }
+    }
+    if (signal == NULL) {
+        if (pool->count == pool->capa) {
+            size_t capa = pool->capa ? pool->capa * 2 : 4;
+
+            REALLOC_N(pool->signals, nogvl_fiber_signal *, capa);
+            REALLOC_N(pool->ios, VALUE, capa);
+            pool->capa = capa;
+        }
+        signal = nogvl_fiber_signal_create(io);
+        pool->signals[pool->count] = signal;
+        RB_OBJ_WRITE(obj, &pool->ios[pool->count], *io);
+        pool->count++;
+    }
+    signal->in_use = true;
+    signal->next = NULL;
+    RUBY_ATOMIC_INC(signal->refcount);
+    return signal;
+}
+
+void nogvl_fiber_signal_release(nogvl_fiber_signal *signal)
+{
+    if (RUBY_ATOMIC_FETCH_SUB(signal->refcount, 1) == 1) {
+        close(signal->write_fd);
+        free(signal);
+    }
+}
+
+/*
+ * Wakes the waiting fiber and drops the notifier's reference. Called without
+ * the GVL: no Ruby API may be used here. If the pool was collected meanwhile
+ * the write fails with EPIPE, which is harmless as Ruby ignores SIGPIPE.
+ */
+static void nogvl_fiber_signal_notify(nogvl_fiber_signal *signal)
+{
+    char byte = 1;
+
+    while (write(signal->write_fd, &byte, 1) < 0 && errno == EINTR) {
+    }
+    nogvl_fiber_signal_release(signal);
+}
+
+/*
+ * Adds the signal to a future's list, unless the list was already taken by
+ * notify_all. Returns whether it was added.
+ */
+bool nogvl_fiber_signal_link(nogvl_fiber_signal **list, nogvl_fiber_signal *signal)
+{
+    nogvl_fiber_signal *head;
+
+    do {
+        head = RUBY_ATOMIC_PTR_LOAD(*list);
+        if (head == NOGVL_FIBER_SIGNALS_DONE) {
+            return false;
+        }
+        signal->next = head;
+    } while (RUBY_ATOMIC_PTR_CAS(*list, head, signal) != head);
+    return true;
+}
+
+/*
+ * Takes a future's list of signals and notifies all of them. Called without
+ * the GVL, once the future completed.
+ */
+void nogvl_fiber_signal_notify_all(nogvl_fiber_signal **list)
+{
+    nogvl_fiber_signal *signal = RUBY_ATOMIC_PTR_EXCHANGE(*list, NOGVL_FIBER_SIGNALS_DONE);
+
+    while (signal) {
+        // Read before notifying, after which the signal may be reused.
+        nogvl_fiber_signal *next = signal->next;
+
+        nogvl_fiber_signal_notify(signal);
+        signal = next;
+    }
+}
+
+static void nogvl_fiber_signal_cb(CassFuture *future, void *data)
+{
+    nogvl_fiber_signal_notify((nogvl_fiber_signal *)data);
+}
+
+static VALUE nogvl_fiber_wait_body(VALUE ptr)
+{
+    nogvl_fiber_wait_args *args = (nogvl_fiber_wait_args *)ptr;
+
+    while (cass_future_ready(args->future) == cass_false) {
+        rb_fiber_scheduler_io_wait(args->scheduler, args->io, RB_INT2NUM(RUBY_IO_READABLE), Qnil);
+    }
+    return Qnil;
+}
+
+static VALUE nogvl_fiber_wait_ensure(VALUE ptr)
+{
+    nogvl_fiber_wait_args *args = (nogvl_fiber_wait_args *)ptr;
+
+    if (args->owned && cass_future_ready(args->future) == cass_false) {
+        // The fiber was interrupted and nothing else references the future.
+        // The driver keeps its own reference until the callback has run.
+        cass_future_free(args->future);
+    }
+    // Back to the pool, which reuses it once the notifier ran.
+    args->signal->in_use = false;
+    return Qnil;
+}
+
+/*
+ * Yields to the scheduler until the future is ready, then returns the signal
+ * to its pool. If owned, the future is freed when the wait is interrupted.
+ */
+void nogvl_fiber_wait(VALUE scheduler, CassFuture *future, nogvl_fiber_signal *signal, VALUE io, bool owned)
+{
+    nogvl_fiber_wait_args args = { scheduler, future, signal, io, owned };
+
+    rb_ensure(nogvl_fiber_wait_body, (VALUE)&args, nogvl_fiber_wait_ensure, (VALUE)&args);
+    ilios_memory_fold();
+}
+
+static bool nogvl_future_fiber_wait(CassFuture *future, bool owned)
+{
+    VALUE scheduler = rb_fiber_scheduler_current();
+    nogvl_fiber_signal *signal;
+    VALUE io;
+
+    if (NIL_P(scheduler) || cass_future_ready(future) == cass_true) {
+        return false;
+    }
+
+    signal = nogvl_fiber_signal_acquire(&io);
+    if (cass_future_set_callback(future, nogvl_fiber_signal_cb, signal) != CASS_OK) {
+        // The future already has a callback, which the driver allows only once.
+        nogvl_fiber_signal_release(signal);
+        signal->in_use = false;
+        return false;
+    }
+    nogvl_fiber_wait(scheduler, future, signal, io, owned);
+    return true;
+}
+#endif
+
+static void nogvl_future_block(CassFuture *future, bool owned)
+{
+#ifdef HAVE_RB_FIBER_SCHEDULER_CURRENT
+    if (nogvl_future_fiber_wait(future, owned)) {
+        return;
+    }
+#endif
     rb_thread_call_without_gvl(nogvl_future_wait_cb, future, RUBY_UBF_PROCESS, 0);
+    ilios_memory_fold();
+}
+
+/*
+ * Waits for a future owned by a Ruby object. Under a fiber scheduler only the
+ * current fiber waits, unless the future already has a callback.
+ */
+void nogvl_future_wait(CassFuture *future)
+{
+    nogvl_future_block(future, false);
+}
+
+/*
+ * Same as nogvl_future_wait, for a future only referenced from the caller's
+ * stack: it is freed if the fiber is interrupted while waiting.
+ */
+void nogvl_future_wait_local(CassFuture *future)
+{
+    nogvl_future_block(future, true);
+}
+
+static void *nogvl_future_wait_all_cb(void *ptr)
+{
+    nogvl_future_wait_all_args *args = (nogvl_future_wait_all_args *)ptr;
+
+    for (size_t i = 0; i < args->count; i++) {
+        cass_future_wait(args->futures[i]);
+    }
+    return NULL;
+}
+
+void nogvl_future_wait_all(CassFuture **futures, size_t count)
+{
+    nogvl_future_wait_all_args args = { futures, count };
+    rb_thread_call_without_gvl(nogvl_future_wait_all_cb, &args, RUBY_UBF_PROCESS, 0);
+    ilios_memory_fold();
 }
 
 static void *nogvl_session_prepare_cb(void *ptr)
@@ -52,6 +415,37 @@ CassFuture *nogvl_session_execute(CassSession* session, CassStatement* statement
     return (CassFuture *)rb_thread_call_without_gvl(nogvl_session_execute_cb, &args, RUBY_UBF_PROCESS, 0);
 }
 
+static void *nogvl_session_execute_batch_cb(void *ptr)
+{
+    nogvl_session_execute_batch_args *args = (nogvl_session_execute_batch_args *)ptr;
+    CassFuture *result_future;
+
+    result_future = cass_session_execute_batch(args->session, args->batch);
+    return (void *)result_future;
+}
+
+CassFuture *nogvl_session_execute_batch(CassSession* session, CassBatch* batch)
+{
+    nogvl_session_execute_batch_args args = { session, batch };
+    return (CassFuture *)rb_thread_call_without_gvl(nogvl_session_execute_batch_cb, &args, RUBY_UBF_PROCESS, 0);
+}
+
+static void *nogvl_session_execute_many_cb(void *ptr)
+{
+    nogvl_session_execute_many_args *args = (nogvl_session_execute_many_args *)ptr;
+
+    for (size_t i = 0; i < args->count; i++) {
+        args->futures[i] = cass_session_execute(args->session, args->statements[i]);
+    }
+    return NULL;
+}
+
+void nogvl_session_execute_many(CassSession* session, CassStatement** statements, CassFuture** futures, size_t count)
+{
+    nogvl_session_execute_many_args args = { session, statements, futures, count };
+    rb_thread_call_without_gvl(nogvl_session_execute_many_cb, &args, RUBY_UBF_PROCESS, 0);
+}
+
 static void *nogvl_sem_wait_cb(void *ptr)
 {
     uv_sem_t *sem = (uv_sem_t *)ptr;
@@ -72,4 +466,5 @@ void nogvl_sem_wait(uv_sem_t *sem)
 {
     // Releases GVL to run another thread while waiting
     rb_thread_call_without_gvl(nogvl_sem_wait_cb, sem, nogvl_sem_wait_ubf, sem);
+    ilios_memory_fold();
 }
@@ -17,262 +17,1888 @@ const rb_data_type_t cassandra_result_data_type = {
     RUBY_TYPED_FREE_IMMEDIATELY | RUBY_TYPED_WB_PROTECTED | RUBY_TYPED_FROZEN_SHAREABLE,
 };
 
+typedef enum {
+  row_as_hash,
+  row_as_array,
+  row_as_struct
+} result_row_type;
+
+static VALUE sym_hash;
+static VALUE sym_array;
+static VALUE sym_struct;
+// Hidden instance variable of views, referencing their page.
+static ID id_view_page;
+
+static void result_page_release(result_page *page)
+{
+    if (RUBY_ATOMIC_FETCH_SUB(page->refcount, 1) == 1) {
+        cass_result_free(page->result);
+        xfree(page);
+    }
+}
+
+static void result_view_page_destroy(void *ptr)
+{
+    if (ptr) {
+        result_page_release((result_page *)ptr);
+    }
+}
+
+static size_t result_view_page_memsize(const void *ptr)
+{
+    return sizeof(result_page);
+}
+
+static const rb_data_type_t result_view_page_data_type = {
+    "Ilios::Cassandra::Result::Page",
+    {
+        NULL,
+        result_view_page_destroy,
+        result_view_page_memsize,
+    },
+    0, 0,
+    RUBY_TYPED_FREE_IMMEDIATELY | RUBY_TYPED_WB_PROTECTED,
+};
+
+#define GET_LOADED_RESULT(obj, var) \
+    do { GET_RESULT(obj, var); result_check_loaded(var); } while (0)
+
+static void result_check_loaded(CassandraResult *cassandra_result)
+{
+    if (cassandra_result->result == NULL) {
+        rb_raise(eExecutionError, "Result was released");
+    }
+}
+
+/*
+ * Estimates the memory a page retains: the driver keeps the response
+ * buffer, with each value prefixed by its length, and a decoded value per
+ * cell of the row being iterated.
+ */
+static size_t result_page_size(const CassResult *result)
+{
+    size_t column_count = cass_result_column_count(result);
+    CassIterator *iterator = cass_iterator_from_result(result);
+    size_t size = column_count * 64;
+
+    while (cass_iterator_next(iterator)) {
+        const CassRow *row = cass_iterator_get_row(iterator);
+
+        for (size_t i = 0; i < column_count; i++) {
+            const CassValue *value = cass_row_get_column(row, i);
+            const cass_byte_t *bytes;
+            size_t length = 0;
+
+            size += sizeof(cass_int32_t);
+            if (cass_value_is_null(value) == cass_false) {
+                size += cass_value_get_bytes(value, &bytes, &length) == CASS_OK ? length : sizeof(cass_int64_t);
+            }
+        }
+    }
+    cass_iterator_free(iterator);
+    return size;
+}
+
+/*
+ * Makes the page the current one. Its size is only estimated when memsize
+ * first asks for it, keeping paging itself free of the extra pass.
+ */
+void result_set_page(CassandraResult *cassandra_result, const CassResult *result)
+{
+    cassandra_result->result = result;
+    cassandra_result->page_size = 0;
+}
+
+/*
+ * Frees the current page, or leaves it to the views into it.
+ */
+static void result_free_page(CassandraResult *cassandra_result)
+{
+    if (cassandra_result->shared_page) {
+        result_page_release(cassandra_result->shared_page);
+        cassandra_result->shared_page = NULL;
+    } else if (cassandra_result->result) {
+        cass_result_free(cassandra_result->result);
+    }
+    cassandra_result->result = NULL;
+    cassandra_result->page_size = 0;
+}
+
+/*
+ * Takes the result out of the result's future, which must be ready.
+ */
+void result_load(CassandraResult *cassandra_result)
+{
+    if (cass_future_error_code(cassandra_result->future) != CASS_OK) {
+        char error[4096] = { 0 };
+
+        strncpy(error, cass_error_desc(cass_future_error_code(cassandra_result->future)), sizeof(error) - 1);
+        rb_raise(eExecutionError, "Unable to wait executing: %s", error);
+    }
+
+    if (cassandra_result->result == NULL) {
+        result_set_page(cassandra_result, cass_future_get_result(cassandra_result->future));
+    }
+}
+
 void result_await(CassandraResult *cassandra_result)
 {
-    nogvl_future_wait(cassandra_result->future);
+    nogvl_future_wait(cassandra_result->future);
+    result_load(cassandra_result);
+}
+
+/*
+ * Replaces the result's page with the next one, returning false if it was
+ * the last page.
+ */
+static bool result_fetch_next_page(CassandraResult *cassandra_result)
+{
+    CassandraStatement *cassandra_statement;
+    CassandraSession *cassandra_session;
+    CassFuture *result_future;
+    CassError error_code;
+
+    // Batch results never have pages and carry no executed statement.
+    if (cassandra_result->executed_statement == NULL ||
+        cass_result_has_more_pages(cassandra_result->result) == cass_false) {
+        return false;
+    }
+
+    GET_STATEMENT(cassandra_result->statement_obj, cassandra_statement);
+    GET_SESSION(cassandra_statement->session_obj, cassandra_session);
+
+    // Reuse this result's own executed statement: it is not shared with other
+    // executions and its previous request has already completed, so setting
+    // the paging state cannot race with the driver's IO thread.
+    cass_statement_set_paging_state(cassandra_result->executed_statement, cassandra_result->result);
+
+    result_future = nogvl_session_execute(cassandra_session->session, cassandra_result->executed_statement);
+    nogvl_future_wait_local(result_future);
+
+    error_code = cass_future_error_code(result_future);
+    if (error_code != CASS_OK) {
+        cass_future_free(result_future);
+        rb_raise(eExecutionError, "Unable to wait executing: %s", cass_error_desc(error_code));
+    }
+
+    result_free_page(cassandra_result);
+    if (cassandra_result->future) {
+        cass_future_free(cassandra_result->future);
+    }
+    result_set_page(cassandra_result, cass_future_get_result(result_future));
+    cassandra_result->future = result_future;
+    cassandra_result->page++;
+    return true;
+}
+
+/**
+ * Loads next page synchronously
+ *
+ * @return [Cassandra::Result, nil] returns self or +nil+ if last page.
+ * @raise [Cassandra::ExecutionError] If the query is invalid or there is something wrong with the session, or the result is being iterated.
+ */
+static VALUE result_next_page(VALUE self)
+{
+    CassandraResult *cassandra_result;
+
+    GET_LOADED_RESULT(self, cassandra_result);
+    if (cassandra_result->prefetching) {
+        rb_raise(eExecutionError, "Result is already being paged");
+    }
+    if (cassandra_result->iterating) {
+        rb_raise(eExecutionError, "Result is being iterated");
+    }
+
+    return result_fetch_next_page(cassandra_result) ? self : Qnil;
+}
+
+/**
+ * Loads next page asynchronously and returns a future result for it.
+ * The next page's request reuses this result's executed statement, so
+ * paging continues from the future's result and this result no longer has
+ * a next page.
+ *
+ * @return [Cassandra::Future, nil] A future for the next page's result, or +nil+ if last page.
+ */
+static VALUE result_next_page_async(VALUE self)
+{
+    CassandraResult *cassandra_result;
+    CassandraStatement *cassandra_statement;
+    CassandraSession *cassandra_session;
+    CassandraFuture *cassandra_future;
+    CassFuture *result_future;
+    VALUE future;
+
+    GET_LOADED_RESULT(self, cassandra_result);
+    if (cassandra_result->prefetching) {
+        rb_raise(eExecutionError, "Result is already being paged");
+    }
+
+    if (cassandra_result->executed_statement == NULL ||
+        cass_result_has_more_pages(cassandra_result->result) == cass_false) {
+        return Qnil;
+    }
+
+    GET_STATEMENT(cassandra_result->statement_obj, cassandra_statement);
+    GET_SESSION(cassandra_statement->session_obj, cassandra_session);
+
+    cass_statement_set_paging_state(cassandra_result->executed_statement, cassandra_result->result);
+    result_future = nogvl_session_execute(cassandra_session->session, cassandra_result->executed_statement);
+
+    future = future_create(result_future, cassandra_statement->session_obj, cassandra_result->statement_obj, execute_async);
+    GET_FUTURE(future, cassandra_future);
+    // The future, then the next page's result, owns the executed statement from now on.
+    cassandra_future->executed_statement = cassandra_result->executed_statement;
+    cassandra_result->executed_statement = NULL;
+    return future;
+}
+
+/**
+ * Returns the paging state token of the current page, to resume paging
+ * after it later with +Cassandra::Statement#paging_state=+, e.g. in another
+ * request or process. Tokens should be treated as opaque.
+ *
+ * @return [String, nil] A binary String, or +nil+ if last page.
+ */
+static VALUE result_paging_state(VALUE self)
+{
+    CassandraResult *cassandra_result;
+    const char *token;
+    size_t token_length;
+
+    GET_LOADED_RESULT(self, cassandra_result);
+
+    if (cass_result_has_more_pages(cassandra_result->result) == cass_false ||
+        cass_result_paging_state_token(cassandra_result->result, &token, &token_length) != CASS_OK) {
+        return Qnil;
+    }
+    return rb_str_new(token, token_length);
+}
+
+/**
+ * Frees the current page and the request behind it right away, instead of
+ * when the result is garbage collected. The result can't be used anymore
+ * afterwards, and lazy rows can only return the values they already read.
+ *
+ * @return [nil]
+ * @raise [Cassandra::ExecutionError] If the result is being paged by each_page or each_all, or iterated.
+ */
+static VALUE result_release(VALUE self)
+{
+    CassandraResult *cassandra_result;
+
+    GET_RESULT(self, cassandra_result);
+    if (cassandra_result->prefetching) {
+        rb_raise(eExecutionError, "Result is being paged");
+    }
+    if (cassandra_result->iterating) {
+        rb_raise(eExecutionError, "Result is being iterated");
+    }
+
+    result_free_page(cassandra_result);
+    if (cassandra_result->future) {
+        cass_future_free(cassandra_result->future);
+        cassandra_result->future = NULL;
+    }
+    if (cassandra_result->executed_statement) {
+        cass_statement_free(cassandra_result->executed_statement);
+        cassandra_result->executed_statement = NULL;
+    }
+    cassandra_result->page++;
+    return Qnil;
+}
+
+static void result_column_set_views(result_column *column, CassandraResult *cassandra_result);
+
+/**
+ * Sets the size from which text and blob values are returned as read-only
+ * +IO::Buffer+ views into the page instead of being copied into Strings.
+ * A view keeps its page alive, also after the result moved on to the next
+ * page. Use +IO::Buffer#get_string+ to copy a view's contents.
+ *
+ * @param threshold [Integer, nil] The size in bytes, or +nil+ to always copy.
+ * @return [Integer, nil] The given threshold.
+ * @raise [ArgumentError] If a negative size was given.
+ * @raise [NotImplementedError] If +IO::Buffer+ is not available.
+ */
+static VALUE result_set_view_threshold(VALUE self, VALUE threshold)
+{
+    CassandraResult *cassandra_result;
+    long bytes = NIL_P(threshold) ? 0 : NUM2LONG(threshold);
+
+#ifndef HAVE_RB_IO_BUFFER_NEW
+    if (bytes > 0) {
+        rb_raise(rb_eNotImpError, "IO::Buffer is not available");
+    }
+#endif
+    if (bytes < 0) {
+        rb_raise(rb_eArgError, "Invalid view threshold: %ld", bytes);
+    }
+
+    GET_RESULT(self, cassandra_result);
+    cassandra_result->view_threshold = (size_t)bytes;
+    for (size_t i = 0; i < cassandra_result->column_count; i++) {
+        result_column_set_views(&cassandra_result->columns[i], cassandra_result);
+    }
+    return threshold;
+}
+
+/**
+ * Returns the size from which text and blob values are returned as
+ * +IO::Buffer+ views.
+ *
+ * @return [Integer, nil] The size in bytes, or +nil+ if values are always copied.
+ */
+static VALUE result_view_threshold(VALUE self)
+{
+    CassandraResult *cassandra_result;
+
+    GET_RESULT(self, cassandra_result);
+    return cassandra_result->view_threshold > 0 ? SIZET2NUM(cassandra_result->view_threshold) : Qnil;
+}
+
+static void result_check_value(CassError error_code, VALUE key)
+{
+    if (error_code != CASS_OK) {
+        rb_raise(eExecutionError, "Unable to get value of %"PRIsVALUE" column: %s", key, cass_error_desc(error_code));
+    }
+}
+
+/*
+ * Returns the bytes of a text or blob cell as a String, or as a read-only
+ * IO::Buffer view into the page if the result has a view threshold and the
+ * cell is at least that large. Views keep the page alive.
+ */
+static VALUE result_bytes_value(const result_column *column, const char *ptr, size_t length)
+{
+#ifdef HAVE_RB_IO_BUFFER_NEW
+    CassandraResult *cassandra_result = column->views;
+
+    if (cassandra_result && length >= cassandra_result->view_threshold) {
+        VALUE page_obj = rb_data_typed_object_wrap(0, NULL, &result_view_page_data_type);
+        VALUE view = rb_io_buffer_new((void *)ptr, length, RB_IO_BUFFER_EXTERNAL | RB_IO_BUFFER_READONLY);
+
+        if (cassandra_result->shared_page == NULL) {
+            result_page *page = ALLOC(result_page);
+
+            page->result = cassandra_result->result;
+            page->refcount = 1;
+            cassandra_result->shared_page = page;
+        }
+        RUBY_ATOMIC_INC(cassandra_result->shared_page->refcount);
+        DATA_PTR(page_obj) = cassandra_result->shared_page;
+        rb_ivar_set(view, id_view_page, page_obj);
+        return view;
+    }
+#endif
+    return rb_str_new(ptr, length);
+}
+
+static VALUE result_decode_tiny_int(const CassValue *value, const result_column *column)
+{
+    cass_int8_t output = 0;
+    result_check_value(cass_value_get_int8(value, &output), column->key);
+    return INT2NUM(output);
+}
+
+static VALUE result_decode_small_int(const CassValue *value, const result_column *column)
+{
+    cass_int16_t output = 0;
+    result_check_value(cass_value_get_int16(value, &output), column->key);
+    return INT2NUM(output);
+}
+
+static VALUE result_decode_int(const CassValue *value, const result_column *column)
+{
+    cass_int32_t output = 0;
+    result_check_value(cass_value_get_int32(value, &output), column->key);
+    return INT2NUM(output);
+}
+
+static VALUE result_decode_bigint(const CassValue *value, const result_column *column)
+{
+    cass_int64_t output = 0;
+    result_check_value(cass_value_get_int64(value, &output), column->key);
+    return LL2NUM(output);
+}
+
+static VALUE result_decode_float(const CassValue *value, const result_column *column)
+{
+    cass_float_t output = 0;
+    result_check_value(cass_value_get_float(value, &output), column->key);
+    return DBL2NUM(output);
+}
+
+static VALUE result_decode_double(const CassValue *value, const result_column *column)
+{
+    cass_double_t output = 0;
+    result_check_value(cass_value_get_double(value, &output), column->key);
+    return DBL2NUM(output);
+}
+
+static VALUE result_decode_boolean(const CassValue *value, const result_column *column)
+{
+    cass_bool_t output = cass_false;
+    result_check_value(cass_value_get_bool(value, &output), column->key);
+    return output == cass_true ? Qtrue : Qfalse;
+}
+
+static VALUE result_decode_text(const CassValue *value, const result_column *column)
+{
+    const char* s = NULL;
+    size_t s_length = 0;
+    result_check_value(cass_value_get_string(value, &s, &s_length), column->key);
+    return result_bytes_value(column, s, s_length);
+}
+
+static VALUE result_decode_blob(const CassValue *value, const result_column *column)
+{
+    const cass_byte_t* b = NULL;
+    size_t b_length = 0;
+    result_check_value(cass_value_get_bytes(value, &b, &b_length), column->key);
+    return result_bytes_value(column, (const char *)b, b_length);
+}
+
+static VALUE result_decode_timestamp(const CassValue *value, const result_column *column)
+{
+    cass_int64_t output = 0;
+    result_check_value(cass_value_get_int64(value, &output), column->key);
+    return rb_time_new(output / 1000, output % 1000 * 1000);
+}
+
+static VALUE result_decode_uuid(const CassValue *value, const result_column *column)
+{
+    CassUuid output = { 0, 0 };
+    char uuid[40];
+    result_check_value(cass_value_get_uuid(value, &output), column->key);
+    cass_uuid_string(output, uuid);
+    return rb_str_new2(uuid);
+}
+
+static VALUE result_decode_unsupported(const CassValue *value, const result_column *column)
+{
+    rb_warn("Unsupported type: %d", cass_value_type(value));
+    return sym_unsupported_column_type;
+}
+
+static void result_extract_int8(const CassValue *value, result_cell *cell)
+{
+    cass_int8_t output = 0;
+    cell->error = cass_value_get_int8(value, &output);
+    cell->as.integer = output;
+}
+
+static void result_extract_int16(const CassValue *value, result_cell *cell)
+{
+    cass_int16_t output = 0;
+    cell->error = cass_value_get_int16(value, &output);
+    cell->as.integer = output;
+}
+
+static void result_extract_int32(const CassValue *value, result_cell *cell)
+{
+    cass_int32_t output = 0;
+    cell->error = cass_value_get_int32(value, &output);
+    cell->as.integer = output;
+}
+
+static void result_extract_int64(const CassValue *value, result_cell *cell)
+{
+    cell->as.integer = 0;
+    cell->error = cass_value_get_int64(value, &cell->as.integer);
+}
+
+static void result_extract_float(const CassValue *value, result_cell *cell)
+{
+    cass_float_t output = 0;
+    cell->error = cass_value_get_float(value, &output);
+    cell->as.floating = output;
+}
+
+static void result_extract_double(const CassValue *value, result_cell *cell)
+{
+    cell->as.floating = 0;
+    cell->error = cass_value_get_double(value, &cell->as.floating);
+}
+
+static void result_extract_bool(const CassValue *value, result_cell *cell)
+{
+    cell->as.boolean = cass_false;
+    cell->error = cass_value_get_bool(value, &cell->as.boolean);
+}
+
+static void result_extract_string(const CassValue *value, result_cell *cell)
+{
+    cell->as.bytes.ptr = NULL;
+    cell->as.bytes.length = 0;
+    cell->error = cass_value_get_string(value, &cell->as.bytes.ptr, &cell->as.bytes.length);
+}
+
+static void result_extract_bytes(const CassValue *value, result_cell *cell)
+{
+    const cass_byte_t *output = NULL;
+    cell->as.bytes.length = 0;
+    cell->error = cass_value_get_bytes(value, &output, &cell->as.bytes.length);
+    cell->as.bytes.ptr = (const char *)output;
+}
+
+static void result_extract_uuid(const CassValue *value, result_cell *cell)
+{
+    cell->as.uuid.time_and_version = 0;
+    cell->as.uuid.clock_seq_and_node = 0;
+    cell->error = cass_value_get_uuid(value, &cell->as.uuid);
+}
+
+static void result_extract_unsupported(const CassValue *value, result_cell *cell)
+{
+}
+
+static VALUE result_materialize_integer(const result_column *column, const result_cell *cell)
+{
+    result_check_value(cell->error, column->key);
+    return LL2NUM(cell->as.integer);
+}
+
+static VALUE result_materialize_floating(const result_column *column, const result_cell *cell)
+{
+    result_check_value(cell->error, column->key);
+    return DBL2NUM(cell->as.floating);
+}
+
+static VALUE result_materialize_boolean(const result_column *column, const result_cell *cell)
+{
+    result_check_value(cell->error, column->key);
+    return cell->as.boolean == cass_true ? Qtrue : Qfalse;
+}
+
+static VALUE result_materialize_bytes(const result_column *column, const result_cell *cell)
+{
+    result_check_value(cell->error, column->key);
+    return result_bytes_value(column, cell->as.bytes.ptr, cell->as.bytes.length);
+}
+
+static VALUE result_materialize_timestamp(const result_column *column, const result_cell *cell)
+{
+    result_check_value(cell->error, column->key);
+    return rb_time_new(cell->as.integer / 1000, cell->as.integer % 1000 * 1000);
+}
+
+static VALUE result_materialize_uuid(const result_column *column, const result_cell *cell)
+{
+    char uuid[40];
+    result_check_value(cell->error, column->key);
+    cass_uuid_string(cell->as.uuid, uuid);
+    return rb_str_new2(uuid);
+}
+
+static VALUE result_materialize_unsupported(const result_column *column, const result_cell *cell)
+{
+    rb_warn("Unsupported type: %d", column->type);
+    return sym_unsupported_column_type;
+}
+
+static void result_column_set_codec(result_column *column)
+{
+    switch (column->type) {
+    case CASS_VALUE_TYPE_TINY_INT:
+        column->decode = result_decode_tiny_int;
+        column->extract = result_extract_int8;
+        column->materialize = result_materialize_integer;
+        break;
+    case CASS_VALUE_TYPE_SMALL_INT:
+        column->decode = result_decode_small_int;
+        column->extract = result_extract_int16;
+        column->materialize = result_materialize_integer;
+        break;
+    case CASS_VALUE_TYPE_INT:
+        column->decode = result_decode_int;
+        column->extract = result_extract_int32;
+        column->materialize = result_materialize_integer;
+        break;
+    case CASS_VALUE_TYPE_BIGINT:
+    case CASS_VALUE_TYPE_COUNTER:
+        column->decode = result_decode_bigint;
+        column->extract = result_extract_int64;
+        column->materialize = result_materialize_integer;
+        break;
+    case CASS_VALUE_TYPE_FLOAT:
+        column->decode = result_decode_float;
+        column->extract = result_extract_float;
+        column->materialize = result_materialize_floating;
+        break;
+    case CASS_VALUE_TYPE_DOUBLE:
+        column->decode = result_decode_double;
+        column->extract = result_extract_double;
+        column->materialize = result_materialize_floating;
+        break;
+    case CASS_VALUE_TYPE_BOOLEAN:
+        column->decode = result_decode_boolean;
+        column->extract = result_extract_bool;
+        column->materialize = result_materialize_boolean;
+        break;
+    case CASS_VALUE_TYPE_TEXT:
+    case CASS_VALUE_TYPE_ASCII:
+    case CASS_VALUE_TYPE_VARCHAR:
+        column->decode = result_decode_text;
+        column->extract = result_extract_string;
+        column->materialize = result_materialize_bytes;
+        break;
+    case CASS_VALUE_TYPE_BLOB:
+        column->decode = result_decode_blob;
+        column->extract = result_extract_bytes;
+        column->materialize = result_materialize_bytes;
+        break;
+    case CASS_VALUE_TYPE_TIMESTAMP:
+        column->decode = result_decode_timestamp;
+        column->extract = result_extract_int64;
+        column->materialize = result_materialize_timestamp;
+        break;
+    case CASS_VALUE_TYPE_UUID:
+        column->decode = result_decode_uuid;
+        column->extract = result_extract_uuid;
+        column->materialize = result_materialize_uuid;
+        break;
+    default:
+        column->decode = result_decode_unsupported;
+        column->extract = result_extract_unsupported;
+        column->materialize = result_materialize_unsupported;
+    }
+}
+
+static void result_column_set_views(result_column *column, CassandraResult *cassandra_result)
+{
+    bool bytes = column->type == CASS_VALUE_TYPE_TEXT || column->type == CASS_VALUE_TYPE_ASCII ||
+                 column->type == CASS_VALUE_TYPE_VARCHAR || column->type == CASS_VALUE_TYPE_BLOB;
+
+    column->views = bytes && cassandra_result->view_threshold > 0 ? cassandra_result : NULL;
+}
+
+/*
+ * Returns the decoder plan of the result, building it from the result's
+ * metadata on first use so that rows don't look up names or dispatch on
+ * types per cell. Pages of a query share the metadata, so the plan is kept
+ * across next_page.
+ */
+const result_column *result_columns(VALUE self, CassandraResult *cassandra_result)
+{
+    size_t column_count = cass_result_column_count(cassandra_result->result);
+
+    if (cassandra_result->columns && cassandra_result->column_count == column_count) {
+        return cassandra_result->columns;
+    }
+
+    xfree(cassandra_result->columns);
+    cassandra_result->columns = NULL;
+    cassandra_result->column_count = 0;
+    cassandra_result->struct_class = 0;
+
+    cassandra_result->columns = ZALLOC_N(result_column, column_count);
+    cassandra_result->column_count = column_count;
+    for (size_t i = 0; i < column_count; i++) {
+        result_column *column = &cassandra_result->columns[i];
+        const char *name = "";
+        size_t name_length = 0;
+
+        cass_result_column_name(cassandra_result->result, i, &name, &name_length);
+        RB_OBJ_WRITE(self, &column->key, rb_enc_interned_str(name, name_length, rb_utf8_encoding()));
+        column->type = cass_result_column_type(cassandra_result->result, i);
+        result_column_set_codec(column);
+        result_column_set_views(column, cassandra_result);
+    }
+    return cassandra_result->columns;
+}
+
+static VALUE result_convert_row(const CassRow *row, const result_column *columns, size_t column_count)
+{
+#ifdef HAVE_RB_HASH_NEW_CAPA
+    VALUE hash = rb_hash_new_capa(column_count);
+#else
+    VALUE hash = rb_hash_new();
+#endif
+
+    for (size_t i = 0; i < column_count; i++) {
+        const CassValue *value = cass_row_get_column(row, i);
+
+        if (cass_value_is_null(value)) {
+            rb_hash_aset(hash, columns[i].key, Qnil);
+        } else {
+            rb_hash_aset(hash, columns[i].key, columns[i].decode(value, &columns[i]));
+        }
+    }
+
+    return hash;
+}
+
+static VALUE result_convert_row_array(const CassRow *row, const result_column *columns, size_t column_count)
+{
+    VALUE array = rb_ary_new_capa(column_count);
+
+    for (size_t i = 0; i < column_count; i++) {
+        const CassValue *value = cass_row_get_column(row, i);
+
+        if (cass_value_is_null(value)) {
+            rb_ary_push(array, Qnil);
+        } else {
+            rb_ary_push(array, columns[i].decode(value, &columns[i]));
+        }
+    }
+
+    return array;
+}
+
+static VALUE result_convert_row_struct(const CassRow *row, const result_column *columns, size_t column_count, VALUE struct_class, VALUE *cells)
+{
+    for (size_t i = 0; i < column_count; i++) {
+        const CassValue *value = cass_row_get_column(row, i);
+
+        cells[i] = cass_value_is_null(value) ? Qnil : columns[i].decode(value, &columns[i]);
+    }
+
+    return rb_class_new_instance((int)column_count, cells, struct_class);
+}
+
+static VALUE result_convert_row_only(const CassRow *row, const result_column *columns, const size_t *indexes, size_t index_count)
+{
+#ifdef HAVE_RB_HASH_NEW_CAPA
+    VALUE hash = rb_hash_new_capa(index_count);
+#else
+    VALUE hash = rb_hash_new();
+#endif
+
+    for (size_t i = 0; i < index_count; i++) {
+        const result_column *column = &columns[indexes[i]];
+        const CassValue *value = cass_row_get_column(row, indexes[i]);
+
+        rb_hash_aset(hash, column->key, cass_value_is_null(value) ? Qnil : column->decode(value, column));
+    }
+
+    return hash;
+}
+
+static bool result_struct_member_name_p(VALUE name)
+{
+    const unsigned char *ptr = (const unsigned char *)RSTRING_PTR(name);
+    long length = RSTRING_LEN(name);
+
+    if (length == 0 || ISDIGIT(ptr[0])) {
+        return false;
+    }
+    for (long i = 0; i < length; i++) {
+        // Non-ASCII characters are valid in Ruby identifiers.
+        if (!ISALNUM(ptr[i]) && ptr[i] != '_' && ptr[i] < 0x80) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Returns the Struct class for rows of the result, created once for its
+ * column plan and kept across its pages.
+ */
+static VALUE result_row_struct(VALUE self, CassandraResult *cassandra_result)
+{
+    const result_column *columns = result_columns(self, cassandra_result);
+    size_t column_count = cassandra_result->column_count;
+    VALUE members;
+
+    if (cassandra_result->struct_class) {
+        return cassandra_result->struct_class;
+    }
+
+    members = rb_ary_new_capa(column_count);
+    for (size_t i = 0; i < column_count; i++) {
+        if (!result_struct_member_name_p(columns[i].key)) {
+            rb_raise(rb_eArgError, "Column %"PRIsVALUE" is not a valid Struct member name, use as: :hash or :array instead", rb_inspect(columns[i].key));
+        }
+        for (size_t j = 0; j < i; j++) {
+            // Keys are interned, so equal names are the same String.
+            if (columns[j].key == columns[i].key) {
+                rb_raise(rb_eArgError, "Duplicate column %"PRIsVALUE" can't be a Struct member, use as: :hash or :array instead", rb_inspect(columns[i].key));
+            }
+        }
+        rb_ary_push(members, rb_str_intern(columns[i].key));
+    }
+    RB_OBJ_WRITE(self, &cassandra_result->struct_class, rb_funcallv(rb_cStruct, id_new, (int)column_count, RARRAY_CONST_PTR(members)));
+    RB_GC_GUARD(members);
+
+    return cassandra_result->struct_class;
+}
+
+struct result_each_arg {
+    VALUE self;
+    CassandraResult *cassandra_result;
+    CassIterator *iterator;
+    result_row_type row_type;
+    // Column indexes to decode for Hash rows, or NULL for every column.
+    const size_t *only;
+    size_t only_count;
+};
+
+static VALUE result_each_body(VALUE a)
+{
+    struct result_each_arg *args = (struct result_each_arg *)a;
+    const result_column *columns = result_columns(args->self, args->cassandra_result);
+    size_t column_count = args->cassandra_result->column_count;
+    VALUE struct_class = Qnil;
+    VALUE cells_buffer = 0;
+    VALUE *cells = NULL;
+
+    while (cass_iterator_next(args->iterator)) {
+        const CassRow *row = cass_iterator_get_row(args->iterator);
+
+        switch (args->row_type) {
+        case row_as_hash:
+            if (args->only) {
+                rb_yield(result_convert_row_only(row, columns, args->only, args->only_count));
+            } else {
+                rb_yield(result_convert_row(row, columns, column_count));
+            }
+            break;
+        case row_as_array:
+            rb_yield(result_convert_row_array(row, columns, column_count));
+            break;
+        case row_as_struct:
+            if (cells == NULL) {
+                struct_class = result_row_struct(args->self, args->cassandra_result);
+                cells = ALLOCV_N(VALUE, cells_buffer, column_count);
+            }
+            rb_yield(result_convert_row_struct(row, columns, column_count, struct_class, cells));
+            break;
+        }
+    }
+
+    if (cells) {
+        ALLOCV_END(cells_buffer);
+    }
+    RB_GC_GUARD(struct_class);
+    return Qnil;
+}
+
+struct result_iteration {
+    CassandraResult *cassandra_result;
+    CassIterator *iterator;
+};
+
+static VALUE result_each_ensure(VALUE a)
+{
+    struct result_iteration *iteration = (struct result_iteration *)a;
+
+    cass_iterator_free(iteration->iterator);
+    iteration->cassandra_result->iterating--;
+    return Qnil;
+}
+
+/*
+ * Runs body over the iterator, keeping the page from being released or
+ * replaced by the Ruby code it calls, and frees the iterator afterwards.
+ */
+static void result_each_guarded(CassandraResult *cassandra_result, CassIterator *iterator, VALUE (*body)(VALUE), VALUE arg)
+{
+    struct result_iteration iteration = { cassandra_result, iterator };
+
+    cassandra_result->iterating++;
+    rb_ensure(body, arg, result_each_ensure, (VALUE)&iteration);
+}
+
+static VALUE result_iterate_only(VALUE self, result_row_type row_type, const size_t *only, size_t only_count)
+{
+    CassandraResult *cassandra_result;
+    CassIterator *iterator;
+    struct result_each_arg args;
+
+    GET_LOADED_RESULT(self, cassandra_result);
+
+    iterator = cass_iterator_from_result(cassandra_result->result);
+    args.self = self;
+    args.cassandra_result = cassandra_result;
+    args.iterator = iterator;
+    args.row_type = row_type;
+    args.only = only;
+    args.only_count = only_count;
+    result_each_guarded(cassandra_result, iterator, result_each_body, (VALUE)&args);
+
+    return self;
+}
+
+static VALUE result_iterate(VALUE self, result_row_type row_type)
+{
+    return result_iterate_only(self, row_type, NULL, 0);
+}
+
+/*
+ * Resolves column names to indexes, once per call rather than once per row.
+ */
+static void result_column_indexes(VALUE self, CassandraResult *cassandra_result, VALUE names, size_t *indexes)
+{
+    const result_column *columns = result_columns(self, cassandra_result);
+
+    for (long i = 0; i < RARRAY_LEN(names); i++) {
+        indexes[i] = result_column_index(columns, cassandra_result->column_count, RARRAY_AREF(names, i));
+    }
+}
+
+static result_row_type result_row_type_from(VALUE as)
+{
+    if (as == Qundef || as == sym_hash) {
+        return row_as_hash;
+    } else if (as == sym_array) {
+        return row_as_array;
+    } else if (as == sym_struct) {
+        return row_as_struct;
+    }
+    rb_raise(rb_eArgError, "Invalid row type: %"PRIsVALUE"", rb_inspect(as));
+    return row_as_hash;
+}
+
+/**
+ * Yield the row of result into a block.
+ *
+ * @param only [Array<String, Symbol>] Decode only these columns. Other columns are left out of the rows.
+ * @return [Cassandra::Result, Enumerator] returns self or +Enumerator+ if block is not given.
+ * @raise [ArgumentError] If an invalid column name was given.
+ */
+static VALUE result_each(int argc, VALUE *argv, VALUE self)
+{
+    static ID keywords[1];
+    CassandraResult *cassandra_result;
+    VALUE options;
+    VALUE only = Qundef;
+    VALUE indexes_buffer = 0;
+    size_t *indexes;
+
+    RETURN_ENUMERATOR(self, argc, argv);
+
+    rb_scan_args(argc, argv, "0:", &options);
+    if (!keywords[0]) {
+        keywords[0] = rb_intern("only");
+    }
+    if (!NIL_P(options)) {
+        rb_get_kwargs(options, keywords, 0, 1, &only);
+    }
+    if (only == Qundef || NIL_P(only)) {
+        return result_iterate(self, row_as_hash);
+    }
+
+    only = rb_Array(only);
+    GET_LOADED_RESULT(self, cassandra_result);
+    indexes = ALLOCV_N(size_t, indexes_buffer, RARRAY_LEN(only) + 1);
+    result_column_indexes(self, cassandra_result, only, indexes);
+    result_iterate_only(self, row_as_hash, indexes, RARRAY_LEN(only));
+    ALLOCV_END(indexes_buffer);
+    RB_GC_GUARD(only);
+
+    return self;
+}
+
+/**
+ * Yield the row of result into a block, as a Hash, an Array of values in
+ * column order, or a Struct. Arrays and Structs skip hashing column names,
+ * and the Struct class is created once per result, shared by its pages.
+ *
+ * @param as [Symbol] +:hash+, +:array+ or +:struct+. The default is +:hash+.
+ * @return [Cassandra::Result, Enumerator] returns self or +Enumerator+ if block is not given.
+ * @raise [ArgumentError] If an invalid row type was given, or for +:struct+, if column names are duplicated or not valid identifiers.
+ */
+static VALUE result_each_row(int argc, VALUE *argv, VALUE self)
+{
+    static ID keywords[1];
+    VALUE options;
+    VALUE as = Qundef;
+
+    RETURN_ENUMERATOR(self, argc, argv);
+
+    rb_scan_args(argc, argv, "0:", &options);
+    if (!keywords[0]) {
+        keywords[0] = rb_intern("as");
+    }
+    if (!NIL_P(options)) {
+        rb_get_kwargs(options, keywords, 0, 1, &as);
+    }
+
+    return result_iterate(self, result_row_type_from(as));
+}
+
+struct result_each_lazy_arg {
+    VALUE self;
+    CassandraResult *cassandra_result;
+    CassIterator *iterator;
+};
+
+static VALUE result_each_lazy_body(VALUE a)
+{
+    struct result_each_lazy_arg *args = (struct result_each_lazy_arg *)a;
+
+    while (cass_iterator_next(args->iterator)) {
+        rb_yield(row_create(args->self, args->cassandra_result, cass_iterator_get_row(args->iterator)));
+    }
+    return Qnil;
+}
+
+/**
+ * Yield the row of result into a block as a {Cassandra::Row}, which
+ * converts a column's value to a Ruby object only when it is first read.
+ * Rows that are skipped after reading a column or two cost little more than
+ * reading the page.
+ *
+ * A row's values can be read until the result moves on to the next page.
+ *
+ * @return [Cassandra::Result, Enumerator] returns self or +Enumerator+ if block is not given.
+ */
+static VALUE result_each_lazy(VALUE self)
+{
+    struct result_each_lazy_arg args;
+
+    RETURN_ENUMERATOR(self, 0, 0);
+
+    GET_LOADED_RESULT(self, args.cassandra_result);
+    args.self = self;
+    args.iterator = cass_iterator_from_result(args.cassandra_result->result);
+    result_each_guarded(args.cassandra_result, args.iterator, result_each_lazy_body, (VALUE)&args);
+
+    return self;
+}
+
+typedef void (*result_row_func)(const CassRow *row, size_t index, void *arg);
+
+struct result_rows_arg {
+    CassIterator *iterator;
+    result_row_func func;
+    void *arg;
+};
+
+static VALUE result_rows_body(VALUE a)
+{
+    struct result_rows_arg *args = (struct result_rows_arg *)a;
+    size_t index = 0;
+
+    while (cass_iterator_next(args->iterator)) {
+        args->func(cass_iterator_get_row(args->iterator), index++, args->arg);
+    }
+    return Qnil;
+}
+
+/*
+ * Calls func for every row of the current page, without yielding to Ruby.
+ */
+static void result_rows(CassandraResult *cassandra_result, result_row_func func, void *arg)
+{
+    struct result_rows_arg args;
+
+    args.iterator = cass_iterator_from_result(cassandra_result->result);
+    args.func = func;
+    args.arg = arg;
+    result_each_guarded(cassandra_result, args.iterator, result_rows_body, (VALUE)&args);
+}
+
+size_t result_column_index(const result_column *columns, size_t column_count, VALUE name)
+{
+    if (SYMBOL_P(name)) {
+        name = rb_sym2str(name);
+    }
+    StringValue(name);
+
+    for (size_t i = 0; i < column_count; i++) {
+        if (rb_str_equal(columns[i].key, name) == Qtrue) {
+            return i;
+        }
+    }
+    rb_raise(rb_eArgError, "Invalid column name: %"PRIsVALUE"", name);
+    return 0;
+}
+
+static VALUE result_decode_cell(const CassRow *row, const result_column *column, size_t index);
+
+struct result_pluck_arg {
+    const result_column *columns;
+    const size_t *indexes;
+    size_t index_count;
+    VALUE array;
+};
+
+static void result_pluck_row(const CassRow *row, size_t index, void *a)
+{
+    struct result_pluck_arg *args = (struct result_pluck_arg *)a;
+
+    if (args->index_count == 1) {
+        rb_ary_push(args->array, result_decode_cell(row, &args->columns[args->indexes[0]], args->indexes[0]));
+    } else {
+        VALUE values = rb_ary_new_capa(args->index_count);
+
+        for (size_t i = 0; i < args->index_count; i++) {
+            rb_ary_push(values, result_decode_cell(row, &args->columns[args->indexes[i]], args->indexes[i]));
+        }
+        rb_ary_push(args->array, values);
+    }
+}
+
+/**
+ * Returns the values of the given columns of the current page. Only these
+ * columns are decoded.
+ *
+ * @param columns [Array<String, Symbol>] The column names.
+ * @return [Array] The values for a single column, or an Array of values per row for several.
+ * @raise [ArgumentError] If no or an invalid column name was given.
+ */
+static VALUE result_pluck(int argc, VALUE *argv, VALUE self)
+{
+    CassandraResult *cassandra_result;
+    struct result_pluck_arg args;
+    VALUE names;
+    VALUE indexes_buffer = 0;
+    size_t *indexes;
+
+    rb_check_arity(argc, 1, UNLIMITED_ARGUMENTS);
+    names = rb_ary_new_from_values(argc, argv);
+
+    GET_LOADED_RESULT(self, cassandra_result);
+    indexes = ALLOCV_N(size_t, indexes_buffer, argc);
+    result_column_indexes(self, cassandra_result, names, indexes);
+    args.columns = result_columns(self, cassandra_result);
+    args.indexes = indexes;
+    args.index_count = argc;
+    args.array = rb_ary_new_capa(cass_result_row_count(cassandra_result->result));
+
+    result_rows(cassandra_result, result_pluck_row, &args);
+    ALLOCV_END(indexes_buffer);
+    RB_GC_GUARD(names);
+    return args.array;
+}
+
+static VALUE result_decode_cell(const CassRow *row, const result_column *column, size_t index)
+{
+    const CassValue *value = cass_row_get_column(row, index);
 
-    if (cass_future_error_code(cassandra_result->future) != CASS_OK) {
-        char error[4096] = { 0 };
+    return cass_value_is_null(value) ? Qnil : column->decode(value, column);
+}
 
-        strncpy(error, cass_error_desc(cass_future_error_code(cassandra_result->future)), sizeof(error) - 1);
-        rb_raise(eExecutionError, "Unable to wait executing: %s", error);
+struct result_columns_arg {
+    const result_column *columns;
+    size_t column_count;
+    // One Array per column.
+    VALUE *arrays;
+};
+
+static void result_columns_row(const CassRow *row, size_t index, void *a)
+{
+    struct result_columns_arg *args = (struct result_columns_arg *)a;
+
+    for (size_t i = 0; i < args->column_count; i++) {
+        rb_ary_push(args->arrays[i], result_decode_cell(row, &args->columns[i], i));
     }
+}
 
-    if (cassandra_result->result == NULL) {
-        cassandra_result->result = cass_future_get_result(cassandra_result->future);
+/**
+ * Returns the values of the current page by column, decoding the page in
+ * one pass.
+ *
+ * @return [Hash<String, Array>] Column names to Arrays of values in row order.
+ */
+static VALUE result_columns_values(VALUE self)
+{
+    CassandraResult *cassandra_result;
+    struct result_columns_arg args;
+    VALUE arrays_buffer;
+    VALUE hash;
+    size_t row_count;
+
+    GET_LOADED_RESULT(self, cassandra_result);
+
+    args.columns = result_columns(self, cassandra_result);
+    args.column_count = cassandra_result->column_count;
+    args.arrays = ALLOCV_N(VALUE, arrays_buffer, args.column_count);
+
+    row_count = cass_result_row_count(cassandra_result->result);
+    hash = rb_hash_new();
+    for (size_t i = 0; i < args.column_count; i++) {
+        args.arrays[i] = rb_ary_new_capa(row_count);
+        rb_hash_aset(hash, args.columns[i].key, args.arrays[i]);
+    }
+
+    result_rows(cassandra_result, result_columns_row, &args);
+    ALLOCV_END(arrays_buffer);
+    return hash;
+}
+
+struct result_column_arg {
+    const result_column *column;
+    size_t column_index;
+    VALUE array;
+    char *packed;
+};
+
+static void result_column_row(const CassRow *row, size_t index, void *a)
+{
+    struct result_column_arg *args = (struct result_column_arg *)a;
+
+    rb_ary_push(args->array, result_decode_cell(row, args->column, args->column_index));
+}
+
+static void result_column_row_packed_int32(const CassRow *row, size_t index, void *a)
+{
+    struct result_column_arg *args = (struct result_column_arg *)a;
+    const CassValue *value = cass_row_get_column(row, args->column_index);
+    cass_int32_t output = 0;
+
+    if (!cass_value_is_null(value)) {
+        result_check_value(cass_value_get_int32(value, &output), args->column->key);
+    }
+    memcpy(args->packed + index * sizeof(output), &output, sizeof(output));
+}
+
+static void result_column_row_packed_int64(const CassRow *row, size_t index, void *a)
+{
+    struct result_column_arg *args = (struct result_column_arg *)a;
+    const CassValue *value = cass_row_get_column(row, args->column_index);
+    cass_int64_t output = 0;
+
+    if (!cass_value_is_null(value)) {
+        result_check_value(cass_value_get_int64(value, &output), args->column->key);
     }
+    memcpy(args->packed + index * sizeof(output), &output, sizeof(output));
+}
+
+static void result_column_row_packed_double(const CassRow *row, size_t index, void *a)
+{
+    struct result_column_arg *args = (struct result_column_arg *)a;
+    const CassValue *value = cass_row_get_column(row, args->column_index);
+    cass_double_t output = 0;
+
+    if (!cass_value_is_null(value)) {
+        result_check_value(cass_value_get_double(value, &output), args->column->key);
+    }
+    memcpy(args->packed + index * sizeof(output), &output, sizeof(output));
 }
 
 /**
- * Loads next page synchronously
+ * Returns the values of a column of the current page.
  *
- * @return [Cassandra::Result, nil] returns self or +nil+ if last page.
- * @raise [Cassandra::ExecutionError] If the query is invalid or there is something wrong with the session.
+ * With +packed: true+, values of an int, bigint or double column are
+ * returned as a binary String of native-endian 32-bit integers, 64-bit
+ * integers or doubles (as +String#unpack+ with +l*+, +q*+ or +d*+), and
+ * NULLs are packed as 0. With +into:+, the packed values are written to the
+ * beginning of the given IO::Buffer instead.
+ *
+ * @param name [String, Symbol] A column name.
+ * @param packed [Boolean] Whether to pack the values.
+ * @param into [IO::Buffer, nil] A buffer to write packed values into.
+ * @return [Array, String, IO::Buffer] The values, the packed String, or the given buffer.
+ * @raise [ArgumentError] If an invalid column name was given, or the buffer is too small.
+ * @raise [TypeError] If the column can't be packed.
  */
-static VALUE result_next_page(VALUE self)
+static VALUE result_column_values(int argc, VALUE *argv, VALUE self)
 {
+    static ID keywords[2];
     CassandraResult *cassandra_result;
-    CassandraStatement *cassandra_statement;
-    CassandraSession *cassandra_session;
-    CassFuture *result_future;
+    const result_column *columns;
+    struct result_column_arg args;
+    result_row_func func;
+    VALUE name, options;
+    VALUE values[2] = { Qundef, Qundef };
+    VALUE packed;
+    size_t row_count, width;
+
+    rb_scan_args(argc, argv, "1:", &name, &options);
+    if (!keywords[0]) {
+        keywords[0] = rb_intern("packed");
+        keywords[1] = rb_intern("into");
+    }
+    if (!NIL_P(options)) {
+        rb_get_kwargs(options, keywords, 0, 2, values);
+    }
+
+    GET_LOADED_RESULT(self, cassandra_result);
+    columns = result_columns(self, cassandra_result);
+    args.column_index = result_column_index(columns, cassandra_result->column_count, name);
+    args.column = &columns[args.column_index];
+    row_count = cass_result_row_count(cassandra_result->result);
+
+    if ((values[0] == Qundef || !RTEST(values[0])) && (values[1] == Qundef || NIL_P(values[1]))) {
+        args.array = rb_ary_new_capa(row_count);
+        result_rows(cassandra_result, result_column_row, &args);
+        return args.array;
+    }
+
+    switch (args.column->type) {
+    case CASS_VALUE_TYPE_INT:
+        func = result_column_row_packed_int32;
+        width = sizeof(cass_int32_t);
+        break;
+    case CASS_VALUE_TYPE_BIGINT:
+    case CASS_VALUE_TYPE_COUNTER:
+        func = result_column_row_packed_int64;
+        width = sizeof(cass_int64_t);
+        break;
+    case CASS_VALUE_TYPE_DOUBLE:
+        func = result_column_row_packed_double;
+        width = sizeof(cass_double_t);
+        break;
+    default:
+        rb_raise(rb_eTypeError, "Unable to pack %"PRIsVALUE" column", args.column->key);
+    }
+
+    if (values[1] != Qundef && !NIL_P(values[1])) {
+#ifdef HAVE_RB_IO_BUFFER_GET_BYTES_FOR_WRITING
+        void *base;
+        size_t size;
+
+        rb_io_buffer_get_bytes_for_writing(values[1], &base, &size);
+        if (size < row_count * width) {
+            rb_raise(rb_eArgError, "Buffer too small: %"PRIuSIZE" bytes given, %"PRIuSIZE" bytes needed", size, row_count * width);
+        }
+        // Decoding doesn't run Ruby code, so the buffer can't be resized meanwhile.
+        args.packed = (char *)base;
+        result_rows(cassandra_result, func, &args);
+        return values[1];
+#else
+        rb_raise(rb_eNotImpError, "IO::Buffer is not supported on this Ruby");
+#endif
+    }
+
+    packed = rb_str_new(NULL, row_count * width);
+    args.packed = RSTRING_PTR(packed);
+    result_rows(cassandra_result, func, &args);
+    return packed;
+}
+
+/*
+ * Pages requested ahead of the consumer. The next page's request is issued
+ * from the driver's callback as soon as a page arrives, so fetching overlaps
+ * with Ruby processing the pages before it. Shared with the callbacks, hence
+ * refcounted and allocated outside of Ruby's heap.
+ */
+typedef struct
+{
+    rb_atomic_t refcount;
+    uv_mutex_t lock;
+    uv_cond_t cond;
+    CassSession *session;
+    // The result's executed statement. Only touched under the lock while not cancelled.
+    CassStatement *statement;
+    bool in_flight;
+    bool finished;
+    bool cancelled;
+    bool interrupted;
     CassError error_code;
+    // Ring of arrived pages, at most depth.
+    const CassResult **pages;
+    size_t depth;
+    size_t head;
+    size_t count;
+} result_prefetch;
 
-    GET_RESULT(self, cassandra_result);
+static void result_prefetch_cb(CassFuture *future, void *data);
 
-    if (cass_result_has_more_pages(cassandra_result->result) == cass_false) {
-        return Qnil;
+static void result_prefetch_release(result_prefetch *prefetch)
+{
+    if (RUBY_ATOMIC_FETCH_SUB(prefetch->refcount, 1) == 1) {
+        for (size_t i = 0; i < prefetch->count; i++) {
+            cass_result_free(prefetch->pages[(prefetch->head + i) % prefetch->depth]);
+        }
+        uv_cond_destroy(&prefetch->cond);
+        uv_mutex_destroy(&prefetch->lock);
+        free(prefetch->pages);
+        free(prefetch);
     }
+}
 
-    GET_STATEMENT(cassandra_result->statement_obj, cassandra_statement);
-    GET_SESSION(cassandra_statement->session_obj, cassandra_session);
+/*
+ * Issues the request for the next page. The paging state must already be
+ * set on the statement. Must be called with the lock held; the returned
+ * future's callback is to be set after unlocking, since it may run
+ * immediately.
+ */
+static CassFuture *result_prefetch_request(result_prefetch *prefetch)
+{
+    RUBY_ATOMIC_INC(prefetch->refcount);
+    prefetch->in_flight = true;
+    return cass_session_execute(prefetch->session, prefetch->statement);
+}
 
-    // Reuse this result's own executed statement: it is not shared with other
-    // executions and its previous request has already completed, so setting
-    // the paging state cannot race with the driver's IO thread.
-    cass_statement_set_paging_state(cassandra_result->executed_statement, cassandra_result->result);
+static void result_prefetch_set_callback(result_prefetch *prefetch, CassFuture *future)
+{
+    if (future && cass_future_set_callback(future, result_prefetch_cb, prefetch) != CASS_OK) {
+        result_prefetch_cb(future, prefetch);
+    }
+}
 
-    result_future = nogvl_session_execute(cassandra_session->session, cassandra_result->executed_statement);
-    nogvl_future_wait(result_future);
+static void result_prefetch_cb(CassFuture *future, void *data)
+{
+    result_prefetch *prefetch = (result_prefetch *)data;
+    CassFuture *next_future = NULL;
 
-    error_code = cass_future_error_code(result_future);
+    uv_mutex_lock(&prefetch->lock);
+    prefetch->in_flight = false;
+
+    if (!prefetch->cancelled) {
+        CassError error_code = cass_future_error_code(future);
+
+        if (error_code != CASS_OK) {
+            prefetch->error_code = error_code;
+            prefetch->finished = true;
+        } else {
+            const CassResult *result = cass_future_get_result(future);
+
+            prefetch->pages[(prefetch->head + prefetch->count) % prefetch->depth] = result;
+            prefetch->count++;
+            if (cass_result_has_more_pages(result)) {
+                cass_statement_set_paging_state(prefetch->statement, result);
+                if (prefetch->count < prefetch->depth) {
+                    next_future = result_prefetch_request(prefetch);
+                }
+            } else {
+                prefetch->finished = true;
+            }
+        }
+        uv_cond_broadcast(&prefetch->cond);
+    }
+
+    uv_mutex_unlock(&prefetch->lock);
+    cass_future_free(future);
+    result_prefetch_set_callback(prefetch, next_future);
+    result_prefetch_release(prefetch);
+}
+
+static void *result_prefetch_wait_cb(void *ptr)
+{
+    result_prefetch *prefetch = (result_prefetch *)ptr;
+
+    uv_mutex_lock(&prefetch->lock);
+    while (prefetch->count == 0 && !prefetch->finished && !prefetch->interrupted) {
+        uv_cond_wait(&prefetch->cond, &prefetch->lock);
+    }
+    prefetch->interrupted = false;
+    uv_mutex_unlock(&prefetch->lock);
+    return NULL;
+}
+
+static void result_prefetch_wait_ubf(void *ptr)
+{
+    result_prefetch *prefetch = (result_prefetch *)ptr;
+
+    uv_mutex_lock(&prefetch->lock);
+    prefetch->interrupted = true;
+    uv_cond_broadcast(&prefetch->cond);
+    uv_mutex_unlock(&prefetch->lock);
+}
+
+/*
+ * Waits for the next page and moves it into the result.
+ */
+static void result_prefetch_take(result_prefetch *prefetch, CassandraResult *cassandra_result)
+{
+    const CassResult *result = NULL;
+    CassFuture *next_future = NULL;
+    CassError error_code = CASS_OK;
+
+    for (;;) {
+        uv_mutex_lock(&prefetch->lock);
+        if (prefetch->count > 0) {
+            result = prefetch->pages[prefetch->head];
+            prefetch->head = (prefetch->head + 1) % prefetch->depth;
+            prefetch->count--;
+            // Resume fetching if it paused because the ring was full.
+            if (!prefetch->in_flight && !prefetch->finished) {
+                next_future = result_prefetch_request(prefetch);
+            }
+        } else if (prefetch->finished) {
+            error_code = prefetch->error_code;
+        }
+        uv_mutex_unlock(&prefetch->lock);
+
+        if (result || error_code != CASS_OK) {
+            break;
+        }
+        rb_thread_call_without_gvl(result_prefetch_wait_cb, prefetch, result_prefetch_wait_ubf, prefetch);
+        rb_thread_check_ints();
+    }
+
+    result_prefetch_set_callback(prefetch, next_future);
     if (error_code != CASS_OK) {
-        cass_future_free(result_future);
         rb_raise(eExecutionError, "Unable to wait executing: %s", cass_error_desc(error_code));
     }
 
-    cass_result_free(cassandra_result->result);
+    result_free_page(cassandra_result);
     if (cassandra_result->future) {
         cass_future_free(cassandra_result->future);
+        cassandra_result->future = NULL;
     }
-    cassandra_result->result = cass_future_get_result(result_future);
-    cassandra_result->future = result_future;
+    result_set_page(cassandra_result, result);
+    cassandra_result->page++;
+}
 
-    return self;
+typedef struct
+{
+    VALUE self;
+    CassandraResult *cassandra_result;
+    result_prefetch *prefetch;
+    // Yield rows of this type, or each page if -1.
+    int row_type;
+} result_pages_arg;
+
+static VALUE result_pages_body(VALUE a)
+{
+    result_pages_arg *args = (result_pages_arg *)a;
+    CassandraResult *cassandra_result = args->cassandra_result;
+
+    if (args->prefetch && cass_result_has_more_pages(cassandra_result->result)) {
+        result_prefetch *prefetch = args->prefetch;
+        CassFuture *future;
+
+        // Start fetching the next page before the first one is processed;
+        // the callback keeps fetching from there.
+        uv_mutex_lock(&prefetch->lock);
+        cass_statement_set_paging_state(prefetch->statement, cassandra_result->result);
+        future = result_prefetch_request(prefetch);
+        uv_mutex_unlock(&prefetch->lock);
+        result_prefetch_set_callback(prefetch, future);
+    }
+
+    for (;;) {
+        bool has_more_pages = cassandra_result->executed_statement != NULL &&
+            cass_result_has_more_pages(cassandra_result->result) == cass_true;
+
+        if (args->row_type < 0) {
+            rb_yield(args->self);
+        } else {
+            result_iterate(args->self, (result_row_type)args->row_type);
+        }
+
+        if (!has_more_pages) {
+            break;
+        }
+        if (args->prefetch) {
+            result_prefetch_take(args->prefetch, cassandra_result);
+        } else {
+            result_fetch_next_page(cassandra_result);
+        }
+    }
+    return args->self;
 }
 
-static void result_check_value(CassError error_code, VALUE key)
+static VALUE result_pages_ensure(VALUE a)
 {
-    if (error_code != CASS_OK) {
-        rb_raise(eExecutionError, "Unable to get value of %"PRIsVALUE" column: %s", key, cass_error_desc(error_code));
+    result_pages_arg *args = (result_pages_arg *)a;
+
+    args->cassandra_result->prefetching = false;
+    if (args->prefetch) {
+        // Pages still arriving are dropped by the callback.
+        uv_mutex_lock(&args->prefetch->lock);
+        args->prefetch->cancelled = true;
+        uv_mutex_unlock(&args->prefetch->lock);
+        result_prefetch_release(args->prefetch);
     }
+    return Qnil;
 }
 
-static VALUE result_convert_row(const CassResult *result, const CassRow *row, size_t column_count)
+static VALUE result_pages(VALUE self, long depth, int row_type)
 {
-    VALUE key;
-    const char *name;
-    size_t name_length;
-    VALUE hash = rb_hash_new();
+    CassandraResult *cassandra_result;
+    result_pages_arg args;
 
-    for (size_t i = 0; i < column_count; i++) {
-        const CassValue *value = cass_row_get_column(row, i);
-        const CassValueType type = cass_value_type(value);
+    GET_LOADED_RESULT(self, cassandra_result);
+    if (cassandra_result->prefetching) {
+        rb_raise(eExecutionError, "Result is already being paged");
+    }
 
-        cass_result_column_name(result, i, &name, &name_length);
-        key = rb_enc_interned_str(name, name_length, rb_utf8_encoding());
+    args.self = self;
+    args.cassandra_result = cassandra_result;
+    args.row_type = row_type;
+    args.prefetch = NULL;
 
-        if (cass_value_is_null(value)) {
-            rb_hash_aset(hash, key, Qnil);
-            continue;
+    if (depth > 0 && cassandra_result->executed_statement) {
+        CassandraStatement *cassandra_statement;
+        CassandraSession *cassandra_session;
+        result_prefetch *prefetch;
+
+        GET_STATEMENT(cassandra_result->statement_obj, cassandra_statement);
+        GET_SESSION(cassandra_statement->session_obj, cassandra_session);
+
+        prefetch = (result_prefetch *)calloc(1, sizeof(result_prefetch));
+        if (prefetch) {
+            prefetch->pages = (const CassResult **)calloc(depth, sizeof(const CassResult *));
         }
+        if (prefetch == NULL || prefetch->pages == NULL) {
+            free(prefetch);
+            rb_memerror();
+        }
+        prefetch->refcount = 1;
+        uv_mutex_init(&prefetch->lock);
+        uv_cond_init(&prefetch->cond);
+        prefetch->session = cassandra_session->session;
+        prefetch->statement = cassandra_result->executed_statement;
+        prefetch->depth = depth;
+        prefetch->error_code = CASS_OK;
+        args.prefetch = prefetch;
+    }
 
-        switch (type) {
-        case CASS_VALUE_TYPE_TINY_INT:
-            {
-                cass_int8_t output = 0;
-                result_check_value(cass_value_get_int8(value, &output), key);
-                rb_hash_aset(hash, key, INT2NUM(output));
-            }
-            break;
+    cassandra_result->prefetching = true;
+    return rb_ensure(result_pages_body, (VALUE)&args, result_pages_ensure, (VALUE)&args);
+}
 
-        case CASS_VALUE_TYPE_SMALL_INT:
-            {
-                cass_int16_t output = 0;
-                result_check_value(cass_value_get_int16(value, &output), key);
-                rb_hash_aset(hash, key, INT2NUM(output));
-            }
-            break;
+static long result_prefetch_depth(VALUE prefetch)
+{
+    long depth = prefetch == Qundef ? 1 : NUM2LONG(prefetch);
 
-        case CASS_VALUE_TYPE_INT:
-            {
-                cass_int32_t output = 0;
-                result_check_value(cass_value_get_int32(value, &output), key);
-                rb_hash_aset(hash, key, INT2NUM(output));
-            }
-            break;
+    if (depth < 0) {
+        rb_raise(rb_eArgError, "prefetch must not be negative: %ld", depth);
+    }
+    return depth;
+}
 
-        case CASS_VALUE_TYPE_BIGINT:
-            {
-                cass_int64_t output = 0;
-                result_check_value(cass_value_get_int64(value, &output), key);
-                rb_hash_aset(hash, key, LL2NUM(output));
-            }
-            break;
+/**
+ * Yields self for the current page and each following page, loading pages
+ * like +next_page+. Up to +prefetch+ pages are requested ahead in the
+ * background, so fetching a page overlaps with processing the ones before it.
+ * +next_page+ must not be called in the block.
+ *
+ * @param prefetch [Integer] The number of pages to fetch ahead. The default is +1+, +0+ disables prefetching.
+ * @return [Cassandra::Result, Enumerator] returns self or +Enumerator+ if block is not given.
+ * @raise [Cassandra::ExecutionError] If loading a page failed.
+ */
+static VALUE result_each_page(int argc, VALUE *argv, VALUE self)
+{
+    static ID keywords[1];
+    VALUE options;
+    VALUE prefetch = Qundef;
 
-        case CASS_VALUE_TYPE_FLOAT:
-            {
-                cass_float_t output = 0;
-                result_check_value(cass_value_get_float(value, &output), key);
-                rb_hash_aset(hash, key, DBL2NUM(output));
-            }
-            break;
+    RETURN_ENUMERATOR(self, argc, argv);
 
-        case CASS_VALUE_TYPE_DOUBLE:
-            {
-                cass_double_t output = 0;
-                result_check_value(cass_value_get_double(value, &output), key);
-                rb_hash_aset(hash, key, DBL2NUM(output));
-            }
-            break;
+    rb_scan_args(argc, argv, "0:", &options);
+    if (!keywords[0]) {
+        keywords[0] = rb_intern("prefetch");
+    }
+    if (!NIL_P(options)) {
+        rb_get_kwargs(options, keywords, 0, 1, &prefetch);
+    }
 
-        case CASS_VALUE_TYPE_BOOLEAN:
-            {
-                cass_bool_t output = cass_false;
-                result_check_value(cass_value_get_bool(value, &output), key);
-                rb_hash_aset(hash, key, output == cass_true ? Qtrue : Qfalse);
-            }
-            break;
+    return result_pages(self, result_prefetch_depth(prefetch), -1);
+}
 
-        case CASS_VALUE_TYPE_TEXT:
-        case CASS_VALUE_TYPE_ASCII:
-        case CASS_VALUE_TYPE_VARCHAR:
-            {
-                const char* s = NULL;
-                size_t s_length = 0;
-                result_check_value(cass_value_get_string(value, &s, &s_length), key);
-                rb_hash_aset(hash, key, rb_str_new(s, s_length));
-            }
-            break;
+/**
+ * Yields every row of the current page and all following pages, prefetching
+ * pages like +each_page+.
+ *
+ * @param prefetch [Integer] The number of pages to fetch ahead. The default is +1+, +0+ disables prefetching.
+ * @param as [Symbol] +:hash+, +:array+ or +:struct+, as +each_row+. The default is +:hash+.
+ * @return [Cassandra::Result, Enumerator] returns self or +Enumerator+ if block is not given.
+ * @raise [Cassandra::ExecutionError] If loading a page failed.
+ */
+static VALUE result_each_all(int argc, VALUE *argv, VALUE self)
+{
+    static ID keywords[2];
+    VALUE options;
+    VALUE values[2] = { Qundef, Qundef };
 
-        case CASS_VALUE_TYPE_TIMESTAMP:
-            {
-                cass_int64_t output = 0;
-                result_check_value(cass_value_get_int64(value, &output), key);
-                rb_hash_aset(hash, key, rb_time_new(output / 1000, output % 1000 * 1000));
-            }
-            break;
+    RETURN_ENUMERATOR(self, argc, argv);
 
-        case CASS_VALUE_TYPE_UUID:
-            {
-                CassUuid output = { 0, 0 };
-                char uuid[40];
-                result_check_value(cass_value_get_uuid(value, &output), key);
-                cass_uuid_string(output, uuid);
-                rb_hash_aset(hash, key, rb_str_new2(uuid));
-            }
-            break;
+    rb_scan_args(argc, argv, "0:", &options);
+    if (!keywords[0]) {
+        keywords[0] = rb_intern("prefetch");
+        keywords[1] = rb_intern("as");
+    }
+    if (!NIL_P(options)) {
+        rb_get_kwargs(options, keywords, 0, 2, values);
+    }
+
+    return result_pages(self, result_prefetch_depth(values[0]), result_row_type_from(values[1]));
+}
+
+typedef struct
+{
+    const CassResult *result;
+    const result_column *columns;
+    size_t column_count;
+    result_cell *cells;
+} result_extract_args;
+
+/*
+ * Extracts every cell of the page in a single pass. The driver reuses one row
+ * per iterator, so a row is only valid until the iterator advances and can't
+ * be handed to another thread; extracting it is only a fixed-width read or a
+ * pointer into the page, as cheap as stepping to the next row.
+ */
+static void *result_extract_nogvl(void *ptr)
+{
+    result_extract_args *args = (result_extract_args *)ptr;
+    CassIterator *iterator = cass_iterator_from_result(args->result);
+    result_cell *cells = args->cells;
+
+    while (cass_iterator_next(iterator)) {
+        const CassRow *row = cass_iterator_get_row(iterator);
+
+        for (size_t i = 0; i < args->column_count; i++) {
+            const CassValue *value = cass_row_get_column(row, i);
 
-        default:
-            rb_warn("Unsupported type: %d", type);
-            rb_hash_aset(hash, key, sym_unsupported_column_type);
+            cells[i].error = CASS_OK;
+            cells[i].null = cass_value_is_null(value) == cass_true;
+            if (!cells[i].null) {
+                args->columns[i].extract(value, &cells[i]);
+            }
         }
+        cells += args->column_count;
     }
-
-    return hash;
+    cass_iterator_free(iterator);
+    return NULL;
 }
 
-struct result_each_arg {
+typedef struct
+{
+    VALUE self;
     CassandraResult *cassandra_result;
-    CassIterator *iterator;
-};
+    result_row_type row_type;
+    result_cell *cells;
+} result_rows_args;
 
-static VALUE result_each_body(VALUE a)
+static VALUE result_materialize_rows(VALUE a)
 {
-    struct result_each_arg *args = (struct result_each_arg *)a;
-    size_t column_count = cass_result_column_count(args->cassandra_result->result);
+    result_rows_args *args = (result_rows_args *)a;
+    const result_column *columns = result_columns(args->self, args->cassandra_result);
+    size_t column_count = args->cassandra_result->column_count;
+    size_t row_count = cass_result_row_count(args->cassandra_result->result);
+    result_extract_args extract_args;
+    VALUE struct_class = Qnil;
+    VALUE cells_buffer = 0;
+    VALUE *values = NULL;
+    VALUE rows;
 
-    while (cass_iterator_next(args->iterator)) {
-        const CassRow *row = cass_iterator_get_row(args->iterator);
-        rb_yield(result_convert_row(args->cassandra_result->result, row, column_count));
+    args->cells = ALLOC_N(result_cell, row_count * column_count);
+    extract_args.result = args->cassandra_result->result;
+    extract_args.columns = columns;
+    extract_args.column_count = column_count;
+    extract_args.cells = args->cells;
+    // Only reads the CassResult and writes native memory, so it runs without
+    // the GVL; it's bounded by the page size, so it is not interruptible.
+    rb_thread_call_without_gvl(result_extract_nogvl, &extract_args, NULL, NULL);
+
+    rows = rb_ary_new_capa(row_count);
+    if (args->row_type == row_as_struct && row_count > 0) {
+        struct_class = result_row_struct(args->self, args->cassandra_result);
+        values = ALLOCV_N(VALUE, cells_buffer, column_count);
     }
-    return Qnil;
+
+    for (size_t r = 0; r < row_count; r++) {
+        const result_cell *cells = &args->cells[r * column_count];
+        VALUE row = Qnil;
+
+        switch (args->row_type) {
+        case row_as_hash:
+#ifdef HAVE_RB_HASH_NEW_CAPA
+            row = rb_hash_new_capa(column_count);
+#else
+            row = rb_hash_new();
+#endif
+            for (size_t i = 0; i < column_count; i++) {
+                rb_hash_aset(row, columns[i].key, cells[i].null ? Qnil : columns[i].materialize(&columns[i], &cells[i]));
+            }
+            break;
+        case row_as_array:
+            row = rb_ary_new_capa(column_count);
+            for (size_t i = 0; i < column_count; i++) {
+                rb_ary_push(row, cells[i].null ? Qnil : columns[i].materialize(&columns[i], &cells[i]));
+            }
+            break;
+        case row_as_struct:
+            for (size_t i = 0; i < column_count; i++) {
+                values[i] = cells[i].null ? Qnil : columns[i].materialize(&columns[i], &cells[i]);
+            }
+            row = rb_class_new_instance((int)column_count, values, struct_class);
+            break;
+        }
+        rb_ary_push(rows, row);
+    }
+
+    if (values) {
+        ALLOCV_END(cells_buffer);
+    }
+    RB_GC_GUARD(struct_class);
+    return rows;
 }
 
-static VALUE result_each_ensure(VALUE a)
+static VALUE result_materialize_rows_ensure(VALUE a)
 {
-    CassIterator *iterator = (CassIterator *)a;
-    cass_iterator_free(iterator);
+    result_rows_args *args = (result_rows_args *)a;
+
+    args->cassandra_result->iterating--;
+    xfree(args->cells);
     return Qnil;
 }
 
 /**
- * Yield the row of result into a block.
+ * Returns all rows of the current page. Cells are first extracted from the
+ * page into native memory in one pass without holding the GVL, so other Ruby
+ * threads keep running; only creating the Ruby objects holds the GVL.
  *
- * @return [Cassandra::Result, Enumerator] returns self or +Enumerator+ if block is not given.
+ * @param as [Symbol] +:hash+, +:array+ or +:struct+, as +each_row+. The default is +:hash+.
+ * @return [Array] The rows.
+ * @raise [ArgumentError] If an invalid row type was given.
  */
-static VALUE result_each(VALUE self)
+static VALUE result_rows_values(int argc, VALUE *argv, VALUE self)
 {
-    CassandraResult *cassandra_result;
-    CassIterator *iterator;
-    struct result_each_arg args;
-
-    RETURN_ENUMERATOR(self, 0, 0);
+    static ID keywords[1];
+    result_rows_args args;
+    VALUE options;
+    VALUE values[1] = { Qundef };
 
-    GET_RESULT(self, cassandra_result);
+    rb_scan_args(argc, argv, "0:", &options);
+    if (!keywords[0]) {
+        keywords[0] = rb_intern("as");
+    }
+    if (!NIL_P(options)) {
+        rb_get_kwargs(options, keywords, 0, 1, values);
+    }
 
-    iterator = cass_iterator_from_result(cassandra_result->result);
-    args.cassandra_result = cassandra_result;
-    args.iterator = iterator;
-    rb_ensure(result_each_body, (VALUE)&args, result_each_ensure, (VALUE)iterator);
+    GET_LOADED_RESULT(self, args.cassandra_result);
+    args.self = self;
+    args.row_type = result_row_type_from(values[0]);
+    args.cells = NULL;
 
-    return self;
+    args.cassandra_result->iterating++;
+    return rb_ensure(result_materialize_rows, (VALUE)&args, result_materialize_rows_ensure, (VALUE)&args);
 }
 
 static void result_mark(void *ptr)
 {
     CassandraResult *cassandra_result = (CassandraResult *)ptr;
     rb_gc_mark_movable(cassandra_result->statement_obj);
+    rb_gc_mark_movable(cassandra_result->struct_class);
+    for (size_t i = 0; i < cassandra_result->column_count; i++) {
+        rb_gc_mark_movable(cassandra_result->columns[i].key);
+    }
 }
 
 static void result_destroy(void *ptr)
 {
     CassandraResult *cassandra_result = (CassandraResult *)ptr;
 
-    if (cassandra_result->result) {
-        cass_result_free(cassandra_result->result);
-    }
+    result_free_page(cassandra_result);
     if (cassandra_result->future) {
         cass_future_free(cassandra_result->future);
     }
     if (cassandra_result->executed_statement) {
         cass_statement_free(cassandra_result->executed_statement);
     }
+    xfree(cassandra_result->columns);
     xfree(cassandra_result);
 }
 
 static size_t result_memsize(const void *ptr)
 {
-    return sizeof(CassandraResult);
+    CassandraResult *cassandra_result = (CassandraResult *)ptr;
+    size_t size = sizeof(CassandraResult) + cassandra_result->column_count * sizeof(result_column);
+
+    // A shared page is retained by views as well, but as long as the result
+    // is on it, it is the result that keeps it.
+    if (cassandra_result->result) {
+        if (cassandra_result->page_size == 0) {
+            cassandra_result->page_size = result_page_size(cassandra_result->result);
+        }
+        size += cassandra_result->page_size;
+    }
+    if (cassandra_result->executed_statement) {
+        size += statement_bound_size(cassandra_result->statement_obj);
+    }
+    return size;
 }
 
 static void result_compact(void *ptr)
@@ -280,14 +1906,36 @@ static void result_compact(void *ptr)
     CassandraResult *cassandra_result = (CassandraResult *)ptr;
 
     cassandra_result->statement_obj = rb_gc_location(cassandra_result->statement_obj);
+    cassandra_result->struct_class = rb_gc_location(cassandra_result->struct_class);
+    for (size_t i = 0; i < cassandra_result->column_count; i++) {
+        cassandra_result->columns[i].key = rb_gc_location(cassandra_result->columns[i].key);
+    }
 }
 
 void Init_result(void)
 {
+    sym_hash = ID2SYM(rb_intern("hash"));
+    sym_array = ID2SYM(rb_intern("array"));
+    sym_struct = ID2SYM(rb_intern("struct"));
+    id_view_page = rb_intern("__ilios_view_page__");
+
     rb_undef_alloc_func(cResult);
 
     rb_include_module(cResult, rb_mEnumerable);
 
     rb_define_method(cResult, "next_page", result_next_page, 0);
-    rb_define_method(cResult, "each", result_each, 0);
+    rb_define_method(cResult, "next_page_async", result_next_page_async, 0);
+    rb_define_method(cResult, "paging_state", result_paging_state, 0);
+    rb_define_method(cResult, "release", result_release, 0);
+    rb_define_method(cResult, "view_threshold", result_view_threshold, 0);
+    rb_define_method(cResult, "view_threshold=", result_set_view_threshold, 1);
+    rb_define_method(cResult, "each_page", result_each_page, -1);
+    rb_define_method(cResult, "each_all", result_each_all, -1);
+    rb_define_method(cResult, "each", result_each, -1);
+    rb_define_method(cResult, "each_row", result_each_row, -1);
+    rb_define_method(cResult, "each_lazy", result_each_lazy, 0);
+    rb_define_method(cResult, "rows", result_rows_values, -1);
+    rb_define_method(cResult, "pluck", result_pluck, -1);
+    rb_define_method(cResult, "columns", result_columns_values, 0);
+    rb_define_method(cResult, "column", result_column_values, -1);
 }
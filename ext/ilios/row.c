@@ -0,0 +1,196 @@
+#include "ilios.h"
+
+static void row_mark(void *ptr);
+static void row_destroy(void *ptr);
+static size_t row_memsize(const void *ptr);
+static void row_compact(void *ptr);
+
+const rb_data_type_t cassandra_row_data_type = {
+    "Ilios::Cassandra::Row",
+    {
+        row_mark,
+        row_destroy,
+        row_memsize,
+        row_compact,
+    },
+    0, 0,
+    RUBY_TYPED_FREE_IMMEDIATELY | RUBY_TYPED_WB_PROTECTED,
+};
+
+/*
+ * Creates a lazy row for the current row of the result's page. The cells are
+ * only extracted, which allocates no Ruby objects.
+ */
+VALUE row_create(VALUE result_obj, CassandraResult *cassandra_result, const CassRow *row)
+{
+    const result_column *columns = result_columns(result_obj, cassandra_result);
+    CassandraRow *cassandra_row;
+    VALUE obj;
+
+    obj = CREATE_ROW(cassandra_row);
+    cassandra_row->page = cassandra_result->page;
+    cassandra_row->cells = ALLOC_N(result_cell, cassandra_result->column_count);
+    cassandra_row->values = ALLOC_N(VALUE, cassandra_result->column_count);
+    // Set last, so that marking never sees the arrays half allocated.
+    cassandra_row->column_count = cassandra_result->column_count;
+    for (size_t i = 0; i < cassandra_row->column_count; i++) {
+        const CassValue *value = cass_row_get_column(row, i);
+        result_cell *cell = &cassandra_row->cells[i];
+
+        cassandra_row->values[i] = Qundef;
+        cell->error = CASS_OK;
+        cell->null = cass_value_is_null(value) == cass_true;
+        if (!cell->null) {
+            columns[i].extract(value, cell);
+        }
+    }
+    RB_OBJ_WRITE(obj, &cassandra_row->result_obj, result_obj);
+
+    return obj;
+}
+
+static const result_column *row_columns(CassandraRow *cassandra_row)
+{
+    CassandraResult *cassandra_result;
+
+    GET_RESULT(cassandra_row->result_obj, cassandra_result);
+    if (cassandra_result->page != cassandra_row->page || cassandra_result->column_count != cassandra_row->column_count) {
+        rb_raise(eExecutionError, "Row's page is no longer loaded");
+    }
+    return cassandra_result->columns;
+}
+
+static VALUE row_value(VALUE self, CassandraRow *cassandra_row, size_t index)
+{
+    if (cassandra_row->values[index] == Qundef) {
+        const result_column *column = &row_columns(cassandra_row)[index];
+        const result_cell *cell = &cassandra_row->cells[index];
+
+        RB_OBJ_WRITE(self, &cassandra_row->values[index], cell->null ? Qnil : column->materialize(column, cell));
+    }
+    return cassandra_row->values[index];
+}
+
+/**
+ * Returns the value of a column, converting it on first access.
+ *
+ * @param column [String, Symbol, Integer] A column name or index.
+ * @return [Object] The value.
+ * @raise [ArgumentError] If an invalid column name was given.
+ * @raise [IndexError] If an invalid column index was given.
+ * @raise [Cassandra::ExecutionError] If the value was not read before the result moved on to the next page.
+ */
+static VALUE row_aref(VALUE self, VALUE column)
+{
+    CassandraRow *cassandra_row;
+    size_t index;
+
+    GET_ROW(self, cassandra_row);
+    if (RB_INTEGER_TYPE_P(column)) {
+        long i = NUM2LONG(column);
+
+        if (i < 0) {
+            i += (long)cassandra_row->column_count;
+        }
+        if (i < 0 || (size_t)i >= cassandra_row->column_count) {
+            rb_raise(rb_eIndexError, "Invalid column index: %"PRIsVALUE"", column);
+        }
+        index = (size_t)i;
+    } else {
+        index = result_column_index(row_columns(cassandra_row), cassandra_row->column_count, column);
+    }
+
+    return row_value(self, cassandra_row, index);
+}
+
+/**
+ * Returns the row as a Hash, converting all of its values.
+ *
+ * @return [Hash] Column names to values.
+ * @raise [Cassandra::ExecutionError] If a value was not read before the result moved on to the next page.
+ */
+static VALUE row_to_h(VALUE self)
+{
+    CassandraRow *cassandra_row;
+    const result_column *columns;
+    VALUE hash;
+
+    GET_ROW(self, cassandra_row);
+    columns = row_columns(cassandra_row);
+#ifdef HAVE_RB_HASH_NEW_CAPA
+    hash = rb_hash_new_capa(cassandra_row->column_count);
+#else
+    hash = rb_hash_new();
+#endif
+    for (size_t i = 0; i < cassandra_row->column_count; i++) {
+        rb_hash_aset(hash, columns[i].key, row_value(self, cassandra_row, i));
+    }
+
+    return hash;
+}
+
+/**
+ * Returns the row's values in column order, converting all of them.
+ *
+ * @return [Array] The values.
+ * @raise [Cassandra::ExecutionError] If a value was not read before the result moved on to the next page.
+ */
+static VALUE row_to_a(VALUE self)
+{
+    CassandraRow *cassandra_row;
+    VALUE array;
+
+    GET_ROW(self, cassandra_row);
+    array = rb_ary_new_capa(cassandra_row->column_count);
+    for (size_t i = 0; i < cassandra_row->column_count; i++) {
+        rb_ary_push(array, row_value(self, cassandra_row, i));
+    }
+
+    return array;
+}
+
+static void row_mark(void *ptr)
+{
+    CassandraRow *cassandra_row = (CassandraRow *)ptr;
+
+    // Keeps the result, and so the CassResult the cells point into, alive.
+    rb_gc_mark_movable(cassandra_row->result_obj);
+    for (size_t i = 0; i < cassandra_row->column_count; i++) {
+        rb_gc_mark_movable(cassandra_row->values[i]);
+    }
+}
+
+static void row_destroy(void *ptr)
+{
+    CassandraRow *cassandra_row = (CassandraRow *)ptr;
+
+    xfree(cassandra_row->cells);
+    xfree(cassandra_row->values);
+    xfree(cassandra_row);
+}
+
+static size_t row_memsize(const void *ptr)
+{
+    const CassandraRow *cassandra_row = (const CassandraRow *)ptr;
+
+    return sizeof(CassandraRow) + cassandra_row->column_count * (sizeof(result_cell) + sizeof(VALUE));
+}
+
+static void row_compact(void *ptr)
+{
+    CassandraRow *cassandra_row = (CassandraRow *)ptr;
+
+    cassandra_row->result_obj = rb_gc_location(cassandra_row->result_obj);
+    for (size_t i = 0; i < cassandra_row->column_count; i++) {
+        cassandra_row->values[i] = rb_gc_location(cassandra_row->values[i]);
+    }
+}
+
+void Init_row(void)
+{
+    rb_undef_alloc_func(cRow);
+
+    rb_define_method(cRow, "[]", row_aref, 1);
+    rb_define_method(cRow, "to_h", row_to_h, 0);
+    rb_define_method(cRow, "to_a", row_to_a, 0);
+}
@@ -53,7 +53,7 @@ static VALUE session_prepare(VALUE self, VALUE query)
     GET_SESSION(self, cassandra_session);
 
     prepare_future = nogvl_session_prepare(cassandra_session->session, query);
-    nogvl_future_wait(prepare_future);
+    nogvl_future_wait_local(prepare_future);
 
     if (cass_future_error_code(prepare_future) != CASS_OK) {
         char error[4096] = { 0 };
@@ -66,7 +66,6 @@ static VALUE session_prepare(VALUE self, VALUE query)
     cassandra_statement_obj = CREATE_STATEMENT(cassandra_statement);
 
     cassandra_statement->prepared = cass_future_get_prepared(prepare_future);
-    cassandra_statement->statement = cass_prepared_bind(cassandra_statement->prepared);
     cassandra_statement->session_obj = self;
     cass_future_free(prepare_future);
 
@@ -137,6 +136,212 @@ static VALUE session_execute(VALUE self, VALUE statement)
     return cassandra_result_obj;
 }
 
+/**
+ * Executes a given batch asynchronously and returns a future result.
+ *
+ * @param batch [Cassandra::Batch] A batch to execute.
+ * @return [Cassandra::Future] A future for result.
+ * @raise [TypeError] If the invalid object is given.
+ */
+static VALUE session_execute_batch_async(VALUE self, VALUE batch)
+{
+    CassandraSession *cassandra_session;
+    CassandraBatch *cassandra_batch;
+    CassBatch *executed_batch;
+    CassFuture *result_future;
+
+    GET_SESSION(self, cassandra_session);
+    GET_BATCH(batch, cassandra_batch);
+
+    executed_batch = batch_build_for_execution(cassandra_batch);
+    result_future = nogvl_session_execute_batch(cassandra_session->session, executed_batch);
+    // The driver's request holds its own reference to the batch internals.
+    cass_batch_free(executed_batch);
+
+    return future_create(result_future, self, batch, execute_async);
+}
+
+/**
+ * Executes a given batch.
+ *
+ * @param batch [Cassandra::Batch] A batch to execute.
+ * @return [Cassandra::Result] A result.
+ * @raise [Cassandra::ExecutionError] If there is something wrong with the session.
+ * @raise [TypeError] If the invalid object is given.
+ */
+static VALUE session_execute_batch(VALUE self, VALUE batch)
+{
+    CassandraSession *cassandra_session;
+    CassandraBatch *cassandra_batch;
+    CassandraResult *cassandra_result;
+    CassBatch *executed_batch;
+    CassFuture *result_future;
+    VALUE cassandra_result_obj;
+
+    GET_SESSION(self, cassandra_session);
+    GET_BATCH(batch, cassandra_batch);
+
+    executed_batch = batch_build_for_execution(cassandra_batch);
+    result_future = nogvl_session_execute_batch(cassandra_session->session, executed_batch);
+    cass_batch_free(executed_batch);
+
+    cassandra_result_obj = CREATE_RESULT(cassandra_result);
+    cassandra_result->future = result_future;
+    cassandra_result->statement_obj = batch;
+
+    result_await(cassandra_result);
+    return cassandra_result_obj;
+}
+
+typedef struct
+{
+    VALUE bound_statements;
+    CassStatement **statements;
+    CassFuture **futures;
+    long count;
+} session_executions;
+
+static VALUE session_build_executions(VALUE arg)
+{
+    session_executions *executions = (session_executions *)arg;
+
+    for (long i = 0; i < executions->count; i++) {
+        CassandraStatement *cassandra_statement;
+
+        GET_STATEMENT(RARRAY_AREF(executions->bound_statements, i), cassandra_statement);
+        executions->statements[i] = statement_build_for_execution(cassandra_statement);
+    }
+    return Qnil;
+}
+
+/*
+ * Binds each element of +values_list+ to a new statement sharing +statement+'s
+ * prepared query and submits all of them with a single GVL release.
+ * +values_list+ must be a frozen snapshot the buffers were sized from.
+ * The caller owns the submitted statements and futures.
+ */
+static void session_submit_executions(VALUE self, VALUE statement, VALUE values_list, session_executions *executions)
+{
+    CassandraSession *cassandra_session;
+    int state = 0;
+
+    GET_SESSION(self, cassandra_session);
+    rb_check_typeddata(statement, &cassandra_statement_data_type);
+    Check_Type(values_list, T_ARRAY);
+
+    executions->count = RARRAY_LEN(values_list);
+    executions->bound_statements = rb_ary_new_capa(executions->count);
+    for (long i = 0; i < executions->count; i++) {
+        rb_ary_push(executions->bound_statements, statement_bind_new(statement, RARRAY_AREF(values_list, i)));
+    }
+
+    MEMZERO(executions->statements, CassStatement *, executions->count);
+    rb_protect(session_build_executions, (VALUE)executions, &state);
+    if (state) {
+        for (long i = 0; i < executions->count; i++) {
+            if (executions->statements[i]) {
+                cass_statement_free(executions->statements[i]);
+            }
+        }
+        rb_jump_tag(state);
+    }
+
+    nogvl_session_execute_many(cassandra_session->session, executions->statements, executions->futures, executions->count);
+}
+
+/**
+ * Executes a given statement once for each set of values asynchronously and
+ * returns future results. All executions are submitted together, releasing
+ * the GVL only once.
+ *
+ * @param statement [Cassandra::Statement] A statement to execute.
+ * @param values_list [Array<Hash, Array>] Values to bind for each execution.
+ * @return [Array<Cassandra::Future>] Futures for results, in the order of +values_list+.
+ * @raise [TypeError] If the invalid object is given.
+ * @raise [Cassandra::StatementError] If an invalid column name was given.
+ */
+static VALUE session_execute_many_async(VALUE self, VALUE statement, VALUE values_list)
+{
+    session_executions executions;
+    VALUE statements_buffer, futures_buffer;
+    VALUE futures;
+
+    Check_Type(values_list, T_ARRAY);
+    // Binding may call back into Ruby, which must not resize the list under
+    // the buffers sized from it.
+    values_list = rb_ary_freeze(rb_ary_dup(values_list));
+    executions.statements = ALLOCV_N(CassStatement *, statements_buffer, RARRAY_LEN(values_list));
+    executions.futures = ALLOCV_N(CassFuture *, futures_buffer, RARRAY_LEN(values_list));
+
+    session_submit_executions(self, statement, values_list, &executions);
+
+    futures = rb_ary_new_capa(executions.count);
+    for (long i = 0; i < executions.count; i++) {
+        CassandraFuture *cassandra_future;
+        VALUE future;
+
+        future = future_create(executions.futures[i], self, RARRAY_AREF(executions.bound_statements, i), execute_async);
+        GET_FUTURE(future, cassandra_future);
+        cassandra_future->executed_statement = executions.statements[i];
+        rb_ary_push(futures, future);
+    }
+
+    ALLOCV_END(statements_buffer);
+    ALLOCV_END(futures_buffer);
+    return futures;
+}
+
+/**
+ * Executes a given statement once for each set of values. All executions are
+ * submitted together and awaited together, releasing the GVL only twice.
+ *
+ * @param statement [Cassandra::Statement] A statement to execute.
+ * @param values_list [Array<Hash, Array>] Values to bind for each execution.
+ * @return [Array<Cassandra::Result>] Results, in the order of +values_list+.
+ * @raise [Cassandra::ExecutionError] If any execution failed.
+ * @raise [TypeError] If the invalid object is given.
+ * @raise [Cassandra::StatementError] If an invalid column name was given.
+ */
+static VALUE session_execute_many(VALUE self, VALUE statement, VALUE values_list)
+{
+    session_executions executions;
+    VALUE statements_buffer, futures_buffer;
+    VALUE results;
+
+    Check_Type(values_list, T_ARRAY);
+    // Binding may call back into Ruby, which must not resize the list under
+    // the buffers sized from it.
+    values_list = rb_ary_freeze(rb_ary_dup(values_list));
+    executions.statements = ALLOCV_N(CassStatement *, statements_buffer, RARRAY_LEN(values_list));
+    executions.futures = ALLOCV_N(CassFuture *, futures_buffer, RARRAY_LEN(values_list));
+
+    session_submit_executions(self, statement, values_list, &executions);
+
+    results = rb_ary_new_capa(executions.count);
+    for (long i = 0; i < executions.count; i++) {
+        CassandraResult *cassandra_result;
+        VALUE cassandra_result_obj;
+
+        cassandra_result_obj = CREATE_RESULT(cassandra_result);
+        cassandra_result->executed_statement = executions.statements[i];
+        cassandra_result->future = executions.futures[i];
+        cassandra_result->statement_obj = RARRAY_AREF(executions.bound_statements, i);
+        rb_ary_push(results, cassandra_result_obj);
+    }
+
+    nogvl_future_wait_all(executions.futures, executions.count);
+    ALLOCV_END(statements_buffer);
+    ALLOCV_END(futures_buffer);
+
+    for (long i = 0; i < executions.count; i++) {
+        CassandraResult *cassandra_result;
+
+        GET_RESULT(RARRAY_AREF(results, i), cassandra_result);
+        result_load(cassandra_result);
+    }
+    return results;
+}
+
 static void session_mark(void *ptr)
 {
     CassandraSession *cassandra_session = (CassandraSession *)ptr;
@@ -173,4 +378,8 @@ void Init_session(void)
     rb_define_method(cSession, "prepare", session_prepare, 1);
     rb_define_method(cSession, "execute_async", session_execute_async, 1);
     rb_define_method(cSession, "execute", session_execute, 1);
+    rb_define_method(cSession, "execute_batch_async", session_execute_batch_async, 1);
+    rb_define_method(cSession, "execute_batch", session_execute_batch, 1);
+    rb_define_method(cSession, "execute_many_async", session_execute_many_async, 2);
+    rb_define_method(cSession, "execute_many", session_execute_many, 2);
 }
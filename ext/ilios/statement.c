@@ -19,170 +19,510 @@ const rb_data_type_t cassandra_statement_data_type = {
 
 typedef struct
 {
-    const CassPrepared *prepared;
-    CassStatement *statement;
-    VALUE bound_values;
+    VALUE self;
+    const CassandraStatement *owner;
+    statement_values *values;
+    // Index to start the next name lookup from. Hash keys usually follow the
+    // order of the query's parameters, so this makes most lookups O(1).
+    size_t cursor;
 } statement_bind_context;
 
-void statement_default_config(CassandraStatement *cassandra_statement)
+static void statement_encode_tiny_int(const statement_parameter *parameter, VALUE value, statement_value *encoded)
 {
-    cassandra_statement->bound_values = Qnil;
-    cassandra_statement->page_size = DEFAULT_PAGE_SIZE;
-    cassandra_statement->idempotent = idempotency_unset;
-    cass_statement_set_paging_size(cassandra_statement->statement, DEFAULT_PAGE_SIZE);
+    long v = NUM2LONG(value);
+
+    if (v < INT8_MIN || v > INT8_MAX) {
+        rb_raise(rb_eRangeError, "Invalid value: %ld", v);
+    }
+    encoded->as.integer = v;
 }
 
-static int hash_cb(VALUE key, VALUE value, VALUE arg)
+static void statement_encode_small_int(const statement_parameter *parameter, VALUE value, statement_value *encoded)
 {
-    statement_bind_context *ctx = (statement_bind_context *)arg;
-    const CassDataType* data_type;
-    CassValueType value_type;
-    CassError result;
-    const char *name;
+    long v = NUM2LONG(value);
 
-    if (SYMBOL_P(key)) {
-        key = rb_sym2str(key);
+    if (v < INT16_MIN || v > INT16_MAX) {
+        rb_raise(rb_eRangeError, "Invalid value: %ld", v);
     }
-    name = StringValueCStr(key);
+    encoded->as.integer = v;
+}
+
+static void statement_encode_int(const statement_parameter *parameter, VALUE value, statement_value *encoded)
+{
+    long v = NUM2LONG(value);
 
-    data_type = cass_prepared_parameter_data_type_by_name(ctx->prepared, name);
-    if (data_type == NULL) {
-        rb_raise(eStatementError, "Invalid name %s was given.", name);
+    if (v < INT32_MIN || v > INT32_MAX) {
+        rb_raise(rb_eRangeError, "Invalid value: %ld", v);
     }
-    value_type = cass_data_type_type(data_type);
+    encoded->as.integer = v;
+}
+
+static void statement_encode_bigint(const statement_parameter *parameter, VALUE value, statement_value *encoded)
+{
+    encoded->as.integer = NUM2LONG(value);
+}
 
-    if (NIL_P(value)) {
-        result = cass_statement_bind_null_by_name(ctx->statement, name);
-        goto result_check;
+static void statement_encode_float(const statement_parameter *parameter, VALUE value, statement_value *encoded)
+{
+    double v = NUM2DBL(value);
+
+    if (!isnan(v) && !isinf(v) && (v < -FLT_MAX || v > FLT_MAX)) {
+        rb_raise(rb_eRangeError, "Invalid value: %lf", v);
     }
+    encoded->as.floating = v;
+}
 
-    switch (value_type) {
-    case CASS_VALUE_TYPE_TINY_INT:
-        {
-            long v = NUM2LONG(value);
+static void statement_encode_double(const statement_parameter *parameter, VALUE value, statement_value *encoded)
+{
+    encoded->as.floating = NUM2DBL(value);
+}
 
-            if (v < INT8_MIN || v > INT8_MAX) {
-                rb_raise(rb_eRangeError, "Invalid value: %ld", v);
-            }
-            result = cass_statement_bind_int8_by_name(ctx->statement, name, (cass_int8_t)v);
-        }
-        break;
+static void statement_encode_boolean(const statement_parameter *parameter, VALUE value, statement_value *encoded)
+{
+    encoded->as.boolean = RTEST(value) ? cass_true : cass_false;
+}
 
-    case CASS_VALUE_TYPE_SMALL_INT:
-        {
-            long v = NUM2LONG(value);
+/*
+ * Returns a frozen string with the contents of +value+. Frozen strings are
+ * referenced as is; others are snapshotted so that a later in-place mutation
+ * by the caller doesn't change what gets bound at execution time. The
+ * snapshot shares the string's buffer, so the bytes are only copied if the
+ * caller mutates the original afterwards.
+ */
+static VALUE statement_string_snapshot(VALUE value)
+{
+    StringValue(value);
+    return OBJ_FROZEN(value) ? value : rb_str_new_frozen(value);
+}
 
-            if (v < INT16_MIN || v > INT16_MAX) {
-                rb_raise(rb_eRangeError, "Invalid value: %ld", v);
-            }
+static void statement_encode_text(const statement_parameter *parameter, VALUE value, statement_value *encoded)
+{
+    // Bound with an explicit length, so no need to scan for NUL.
+    encoded->object = statement_string_snapshot(value);
+}
 
-            result = cass_statement_bind_int16_by_name(ctx->statement, name, (cass_int16_t)v);
+static void statement_encode_blob(const statement_parameter *parameter, VALUE value, statement_value *encoded)
+{
+#ifdef HAVE_RB_IO_BUFFER_GET_BYTES_FOR_READING
+    if (rb_obj_is_kind_of(value, rb_cIOBuffer)) {
+        // Referenced, not copied: the buffer's contents at execution time are bound.
+        encoded->object = value;
+        return;
+    }
+#endif
+    encoded->object = statement_string_snapshot(value);
+}
+
+static void statement_encode_timestamp(const statement_parameter *parameter, VALUE value, statement_value *encoded)
+{
+    if (rb_obj_class(value) != rb_cTime) {
+        if (rb_respond_to(value, id_to_time)) {
+            value = rb_funcall(value, id_to_time, 0);
+        } else {
+            rb_raise(rb_eTypeError, "no implicit conversion of %"PRIsVALUE" to Time", rb_obj_class(value));
         }
-        break;
+    }
+    encoded->as.integer = (cass_int64_t)(NUM2DBL(rb_Float(value)) * 1000);
+}
 
-    case CASS_VALUE_TYPE_INT:
-        {
-            long v = NUM2LONG(value);
+static void statement_encode_uuid(const statement_parameter *parameter, VALUE value, statement_value *encoded)
+{
+    CassUuid uuid = { 0, 0 };
+    const char *uuid_string = StringValueCStr(value);
 
-            if (v < INT32_MIN || v > INT32_MAX) {
-                rb_raise(rb_eRangeError, "Invalid value: %ld", v);
-            }
+    if (cass_uuid_from_string(uuid_string, &uuid) != CASS_OK) {
+        rb_raise(eStatementError, "Invalid UUID was given: %.*s=%"PRIsVALUE"", (int)parameter->name_length, parameter->name, value);
+    }
+    encoded->as.uuid = uuid;
+}
 
-            result = cass_statement_bind_int32_by_name(ctx->statement, name, (cass_int32_t)v);
-        }
-        break;
+static void statement_encode_unsupported(const statement_parameter *parameter, VALUE value, statement_value *encoded)
+{
+    rb_raise(rb_eTypeError, "Unsupported %"PRIsVALUE" type: %.*s=%"PRIsVALUE"", rb_obj_class(value), (int)parameter->name_length, parameter->name, value);
+}
 
-    case CASS_VALUE_TYPE_BIGINT:
-        result = cass_statement_bind_int64_by_name(ctx->statement, name, NUM2LONG(value));
-        break;
+static CassError statement_apply_int8(CassStatement *statement, size_t index, const statement_value *encoded)
+{
+    return cass_statement_bind_int8(statement, index, (cass_int8_t)encoded->as.integer);
+}
 
-    case CASS_VALUE_TYPE_FLOAT:
-        {
-            double v = NUM2DBL(value);
+static CassError statement_apply_int16(CassStatement *statement, size_t index, const statement_value *encoded)
+{
+    return cass_statement_bind_int16(statement, index, (cass_int16_t)encoded->as.integer);
+}
 
-            if (!isnan(v) && !isinf(v) && (v < -FLT_MAX || v > FLT_MAX)) {
-                rb_raise(rb_eRangeError, "Invalid value: %lf", v);
-            }
+static CassError statement_apply_int32(CassStatement *statement, size_t index, const statement_value *encoded)
+{
+    return cass_statement_bind_int32(statement, index, (cass_int32_t)encoded->as.integer);
+}
 
-            result = cass_statement_bind_float_by_name(ctx->statement, name, v);
+static CassError statement_apply_int64(CassStatement *statement, size_t index, const statement_value *encoded)
+{
+    return cass_statement_bind_int64(statement, index, encoded->as.integer);
+}
+
+static CassError statement_apply_float(CassStatement *statement, size_t index, const statement_value *encoded)
+{
+    return cass_statement_bind_float(statement, index, (cass_float_t)encoded->as.floating);
+}
+
+static CassError statement_apply_double(CassStatement *statement, size_t index, const statement_value *encoded)
+{
+    return cass_statement_bind_double(statement, index, encoded->as.floating);
+}
+
+static CassError statement_apply_bool(CassStatement *statement, size_t index, const statement_value *encoded)
+{
+    return cass_statement_bind_bool(statement, index, encoded->as.boolean);
+}
+
+#ifdef HAVE_RB_IO_BUFFER_GET_BYTES_FOR_READING
+typedef struct
+{
+    VALUE buffer;
+    const void *base;
+    size_t size;
+} statement_io_buffer_bytes_args;
+
+static VALUE statement_io_buffer_bytes(VALUE arg)
+{
+    statement_io_buffer_bytes_args *args = (statement_io_buffer_bytes_args *)arg;
+
+    rb_io_buffer_get_bytes_for_reading(args->buffer, &args->base, &args->size);
+    return Qnil;
+}
+#endif
+
+/*
+ * Gets the bytes of a String or IO::Buffer value without raising, since it
+ * runs while a CassStatement is being built. Returns false if an IO::Buffer
+ * is no longer readable (e.g. it was freed after binding).
+ */
+static bool statement_value_bytes(const statement_value *encoded, const char **bytes, size_t *length)
+{
+#ifdef HAVE_RB_IO_BUFFER_GET_BYTES_FOR_READING
+    if (!RB_TYPE_P(encoded->object, T_STRING)) {
+        statement_io_buffer_bytes_args args = { encoded->object, NULL, 0 };
+        int state = 0;
+
+        rb_protect(statement_io_buffer_bytes, (VALUE)&args, &state);
+        if (state) {
+            rb_set_errinfo(Qnil);
+            return false;
         }
-        break;
+        *bytes = (const char *)args.base;
+        *length = args.size;
+        return true;
+    }
+#endif
+    *bytes = RSTRING_PTR(encoded->object);
+    *length = RSTRING_LEN(encoded->object);
+    return true;
+}
+
+static CassError statement_apply_string(CassStatement *statement, size_t index, const statement_value *encoded)
+{
+    return cass_statement_bind_string_n(statement, index, RSTRING_PTR(encoded->object), RSTRING_LEN(encoded->object));
+}
+
+static CassError statement_apply_bytes(CassStatement *statement, size_t index, const statement_value *encoded)
+{
+    const char *bytes;
+    size_t length;
+
+    if (!statement_value_bytes(encoded, &bytes, &length)) {
+        return CASS_ERROR_LIB_INVALID_VALUE_TYPE;
+    }
+    return cass_statement_bind_bytes(statement, index, (const cass_byte_t *)bytes, length);
+}
+
+static CassError statement_apply_uuid(CassStatement *statement, size_t index, const statement_value *encoded)
+{
+    return cass_statement_bind_uuid(statement, index, encoded->as.uuid);
+}
 
+static void statement_parameter_set_codec(statement_parameter *parameter)
+{
+    switch (parameter->type) {
+    case CASS_VALUE_TYPE_TINY_INT:
+        parameter->encode = statement_encode_tiny_int;
+        parameter->apply = statement_apply_int8;
+        break;
+    case CASS_VALUE_TYPE_SMALL_INT:
+        parameter->encode = statement_encode_small_int;
+        parameter->apply = statement_apply_int16;
+        break;
+    case CASS_VALUE_TYPE_INT:
+        parameter->encode = statement_encode_int;
+        parameter->apply = statement_apply_int32;
+        break;
+    case CASS_VALUE_TYPE_BIGINT:
+        parameter->encode = statement_encode_bigint;
+        parameter->apply = statement_apply_int64;
+        break;
+    case CASS_VALUE_TYPE_FLOAT:
+        parameter->encode = statement_encode_float;
+        parameter->apply = statement_apply_float;
+        break;
     case CASS_VALUE_TYPE_DOUBLE:
-        result = cass_statement_bind_double_by_name(ctx->statement, name, NUM2DBL(value));
+        parameter->encode = statement_encode_double;
+        parameter->apply = statement_apply_double;
         break;
-
     case CASS_VALUE_TYPE_BOOLEAN:
-        {
-            cass_bool_t v = RTEST(value) ? cass_true : cass_false;
-            result = cass_statement_bind_bool_by_name(ctx->statement, name, v);
-        }
+        parameter->encode = statement_encode_boolean;
+        parameter->apply = statement_apply_bool;
         break;
-
     case CASS_VALUE_TYPE_TEXT:
     case CASS_VALUE_TYPE_ASCII:
     case CASS_VALUE_TYPE_VARCHAR:
-        result = cass_statement_bind_string_by_name(ctx->statement, name, StringValueCStr(value));
+        parameter->encode = statement_encode_text;
+        parameter->apply = statement_apply_string;
+        break;
+    case CASS_VALUE_TYPE_BLOB:
+        parameter->encode = statement_encode_blob;
+        parameter->apply = statement_apply_bytes;
         break;
-
     case CASS_VALUE_TYPE_TIMESTAMP:
-        if (rb_obj_class(value) != rb_cTime) {
-            if (rb_respond_to(value, id_to_time)) {
-                value = rb_funcall(value, id_to_time, 0);
-            } else {
-                rb_raise(rb_eTypeError, "no implicit conversion of %"PRIsVALUE" to Time", rb_obj_class(value));
-            }
-        }
-        result = cass_statement_bind_int64_by_name(ctx->statement, name, (cass_int64_t)(NUM2DBL(rb_Float(value)) * 1000));
+        parameter->encode = statement_encode_timestamp;
+        parameter->apply = statement_apply_int64;
         break;
-
     case CASS_VALUE_TYPE_UUID:
-        {
-            CassUuid uuid = { 0, 0 };
-            const char *uuid_string = StringValueCStr(value);
+        parameter->encode = statement_encode_uuid;
+        parameter->apply = statement_apply_uuid;
+        break;
+    default:
+        parameter->encode = statement_encode_unsupported;
+        parameter->apply = NULL;
+    }
+}
 
-            result = cass_uuid_from_string(uuid_string, &uuid);
-            if (result != CASS_OK) {
-                rb_raise(eStatementError, "Invalid UUID was given: %s=%"PRIsVALUE"", name, value);
+/*
+ * Resolves the prepared query's parameters once, so that binding and every
+ * execution can work by index without looking up names in the driver.
+ */
+static void statement_build_parameters(CassandraStatement *cassandra_statement)
+{
+    statement_parameter *parameters;
+    size_t count = 0;
+
+    while (cass_prepared_parameter_data_type(cassandra_statement->prepared, count) != NULL) {
+        count++;
+    }
+
+    parameters = ALLOC_N(statement_parameter, count);
+    for (size_t i = 0; i < count; i++) {
+        statement_parameter *parameter = &parameters[i];
+        const CassDataType *data_type = cass_prepared_parameter_data_type(cassandra_statement->prepared, i);
+
+        parameter->index = i;
+        parameter->name = "";
+        parameter->name_length = 0;
+        cass_prepared_parameter_name(cassandra_statement->prepared, i, &parameter->name, &parameter->name_length);
+        parameter->symbol = ID2SYM(rb_intern3(parameter->name, parameter->name_length, rb_utf8_encoding()));
+        parameter->type = cass_data_type_type(data_type);
+        statement_parameter_set_codec(parameter);
+
+        // A name may be used by several parameters (e.g. "a = :x OR b = :x"),
+        // binding by name sets all of them like the driver's *_by_name API.
+        parameter->first = i;
+        parameter->next = NULL;
+        for (size_t j = 0; j < i; j++) {
+            if (parameters[j].symbol == parameter->symbol) {
+                statement_parameter *last = &parameters[parameters[j].first];
+
+                while (last->next) {
+                    last = last->next;
+                }
+                last->next = parameter;
+                parameter->first = last->first;
+                break;
             }
+        }
+    }
+
+    cassandra_statement->parameters = parameters;
+    cassandra_statement->parameter_count = count;
+}
+
+void statement_default_config(CassandraStatement *cassandra_statement)
+{
+    cassandra_statement->bound_values = NULL;
+    cassandra_statement->page_size = DEFAULT_PAGE_SIZE;
+    cassandra_statement->idempotent = idempotency_unset;
+    statement_build_parameters(cassandra_statement);
+}
 
-            result = cass_statement_bind_uuid_by_name(ctx->statement, name, uuid);
+static CassandraStatement *statement_owner(CassandraStatement *cassandra_statement)
+{
+    CassandraStatement *owner;
+
+    if (!cassandra_statement->prepared_obj) {
+        return cassandra_statement;
+    }
+    GET_STATEMENT(cassandra_statement->prepared_obj, owner);
+    return owner;
+}
+
+static void statement_values_retain(statement_values *values)
+{
+    if (values) {
+        RUBY_ATOMIC_INC(values->refcount);
+    }
+}
+
+static void statement_values_release(statement_values *values)
+{
+    if (values && RUBY_ATOMIC_FETCH_SUB(values->refcount, 1) == 1) {
+        xfree(values);
+    }
+}
+
+/*
+ * Estimates the bytes the bound values take once encoded into a
+ * CassStatement, which executions keep until they are freed.
+ */
+size_t statement_bound_size(VALUE statement)
+{
+    CassandraStatement *cassandra_statement;
+    statement_values *values;
+    size_t size = 0;
+
+    if (!rb_typeddata_is_kind_of(statement, &cassandra_statement_data_type)) {
+        return 0;
+    }
+    cassandra_statement = (CassandraStatement *)RTYPEDDATA_DATA(statement);
+    values = cassandra_statement->bound_values;
+    if (values == NULL) {
+        return 0;
+    }
+
+    for (size_t i = 0; i < values->count; i++) {
+        const statement_value *value = &values->values[i];
+
+        size += sizeof(cass_int32_t);
+        if (value->state == statement_value_set) {
+            size += value->object && RB_TYPE_P(value->object, T_STRING) ? (size_t)RSTRING_LEN(value->object) : sizeof(value->as);
         }
-        break;
+    }
+    return size;
+}
 
-    default:
-        rb_raise(rb_eTypeError, "Unsupported %"PRIsVALUE" type: %s=%"PRIsVALUE"", rb_obj_class(value), name, value);
+/*
+ * Returns bound values of the statement which are safe to modify, copying
+ * them first if they are shared with other statements.
+ */
+static statement_values *statement_values_modify(VALUE self, CassandraStatement *cassandra_statement, size_t count)
+{
+    statement_values *values = cassandra_statement->bound_values;
+    statement_values *copy;
+
+    if (values && values->refcount == 1) {
+        return values;
+    }
+
+    copy = (statement_values *)xmalloc(sizeof(statement_values) + sizeof(statement_value) * count);
+    copy->refcount = 1;
+    copy->count = count;
+    if (values) {
+        MEMCPY(copy->values, values->values, statement_value, count);
+        for (size_t i = 0; i < count; i++) {
+            if (copy->values[i].object) {
+                RB_OBJ_WRITTEN(self, Qundef, copy->values[i].object);
+            }
+        }
+    } else {
+        for (size_t i = 0; i < count; i++) {
+            copy->values[i].state = statement_value_unset;
+            copy->values[i].object = 0;
+        }
     }
 
-result_check:
-    if (result != CASS_OK) {
-        rb_raise(eStatementError, "Failed to bind value: %s", cass_error_desc(result));
+    cassandra_statement->bound_values = copy;
+    statement_values_release(values);
+    return copy;
+}
+
+static bool statement_parameter_name_eq(const statement_parameter *parameter, const char *name, size_t name_length, bool ignore_case)
+{
+    if (parameter->name_length != name_length) {
+        return false;
+    }
+    if (ignore_case) {
+        return STRNCASECMP(parameter->name, name, name_length) == 0;
+    }
+    return memcmp(parameter->name, name, name_length) == 0;
+}
+
+static const statement_parameter *statement_find_parameter(statement_bind_context *ctx, VALUE key)
+{
+    const CassandraStatement *owner = ctx->owner;
+    size_t count = owner->parameter_count;
+    const char *name;
+    long name_length;
+    bool ignore_case = true;
+
+    if (SYMBOL_P(key)) {
+        for (size_t i = 0; i < count; i++) {
+            const statement_parameter *parameter = &owner->parameters[(ctx->cursor + i) % count];
+
+            if (parameter->symbol == key) {
+                ctx->cursor = parameter->index + 1;
+                return &owner->parameters[parameter->first];
+            }
+        }
+        key = rb_sym2str(key);
     }
+    StringValue(key);
+    name = RSTRING_PTR(key);
+    name_length = RSTRING_LEN(key);
+
+    // Same rules as the driver: a double-quoted name is matched exactly,
+    // otherwise names are case-insensitive.
+    if (name_length >= 2 && name[0] == '"' && name[name_length - 1] == '"') {
+        name++;
+        name_length -= 2;
+        ignore_case = false;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        const statement_parameter *parameter = &owner->parameters[(ctx->cursor + i) % count];
 
-    if (!NIL_P(ctx->bound_values)) {
-        if (RB_TYPE_P(value, T_STRING)) {
-            // Snapshot the value so a later in-place mutation by the caller
-            // doesn't change what gets bound at execution time.
-            value = rb_str_new_frozen(value);
+        if (statement_parameter_name_eq(parameter, name, name_length, false) ||
+            (ignore_case && statement_parameter_name_eq(parameter, name, name_length, true))) {
+            ctx->cursor = parameter->index + 1;
+            return &owner->parameters[parameter->first];
         }
-        rb_hash_aset(ctx->bound_values, key, value);
     }
 
-    return ST_CONTINUE;
+    rb_raise(eStatementError, "Invalid name %"PRIsVALUE" was given.", key);
+    return NULL;
 }
 
-typedef struct
+static void statement_bind_value(statement_bind_context *ctx, const statement_parameter *parameter, VALUE value)
 {
-    statement_bind_context ctx;
-    VALUE hash;
-} statement_rebind_args;
+    statement_value encoded = { statement_value_null, { 0 }, 0 };
+
+    if (!NIL_P(value)) {
+        encoded.state = statement_value_set;
+        parameter->encode(parameter, value, &encoded);
+    }
 
-static VALUE statement_rebind_body(VALUE arg)
+    // Only this parameter is re-encoded, other bound values are kept as is.
+    ctx->values->values[parameter->index] = encoded;
+    if (encoded.object) {
+        RB_OBJ_WRITTEN(ctx->self, Qundef, encoded.object);
+    }
+}
+
+static int hash_cb(VALUE key, VALUE value, VALUE arg)
 {
-    statement_rebind_args *args = (statement_rebind_args *)arg;
+    statement_bind_context *ctx = (statement_bind_context *)arg;
+    const statement_parameter *parameter = statement_find_parameter(ctx, key);
 
-    rb_hash_foreach(args->hash, hash_cb, (VALUE)&args->ctx);
-    return Qnil;
+    for (; parameter; parameter = parameter->next) {
+        statement_bind_value(ctx, parameter, value);
+    }
+    return ST_CONTINUE;
 }
 
 /*
@@ -194,65 +534,208 @@ static VALUE statement_rebind_body(VALUE arg)
 CassStatement *statement_build_for_execution(CassandraStatement *cassandra_statement)
 {
     CassStatement *statement = cass_prepared_bind(cassandra_statement->prepared);
+    const statement_values *values = cassandra_statement->bound_values;
 
     cass_statement_set_paging_size(statement, cassandra_statement->page_size);
     if (cassandra_statement->idempotent != idempotency_unset) {
         cass_statement_set_is_idempotent(statement, cassandra_statement->idempotent == idempotency_true ? cass_true : cass_false);
     }
+    if (cassandra_statement->paging_state) {
+        cass_statement_set_paging_state_token(statement, RSTRING_PTR(cassandra_statement->paging_state), RSTRING_LEN(cassandra_statement->paging_state));
+    }
 
-    if (!NIL_P(cassandra_statement->bound_values)) {
-        statement_rebind_args args;
-        int state = 0;
-
-        args.ctx.prepared = cassandra_statement->prepared;
-        args.ctx.statement = statement;
-        args.ctx.bound_values = Qnil;
-        args.hash = cassandra_statement->bound_values;
+    if (values) {
+        // Values were converted from Ruby objects when they were bound, so no
+        // Ruby code runs here.
+        const CassandraStatement *owner = statement_owner(cassandra_statement);
+
+        for (size_t i = 0; i < values->count; i++) {
+            const statement_value *value = &values->values[i];
+            CassError result = CASS_OK;
+
+            switch (value->state) {
+            case statement_value_unset:
+                break;
+            case statement_value_null:
+                result = cass_statement_bind_null(statement, i);
+                break;
+            case statement_value_set:
+                result = owner->parameters[i].apply(statement, i, value);
+                break;
+            }
 
-        rb_protect(statement_rebind_body, (VALUE)&args, &state);
-        if (state) {
-            cass_statement_free(statement);
-            rb_jump_tag(state);
+            if (result != CASS_OK) {
+                cass_statement_free(statement);
+                rb_raise(eStatementError, "Failed to bind value: %s", cass_error_desc(result));
+            }
         }
     }
     return statement;
 }
 
+static void statement_bind_values(VALUE self, CassandraStatement *cassandra_statement, VALUE values)
+{
+    statement_bind_context ctx;
+
+    if (!RB_TYPE_P(values, T_HASH) && !RB_TYPE_P(values, T_ARRAY)) {
+        rb_raise(rb_eTypeError, "wrong argument type %"PRIsVALUE" (expected Hash or Array)", rb_obj_class(values));
+    }
+
+    ctx.self = self;
+    ctx.owner = statement_owner(cassandra_statement);
+    ctx.cursor = 0;
+
+    if (RB_TYPE_P(values, T_ARRAY) && RARRAY_LEN(values) > (long)ctx.owner->parameter_count) {
+        rb_raise(rb_eArgError, "wrong number of values (given %ld, expected %"PRIuSIZE")", RARRAY_LEN(values), ctx.owner->parameter_count);
+    }
+    if (RB_TYPE_P(values, T_ARRAY) ? RARRAY_LEN(values) == 0 : RHASH_SIZE(values) == 0) {
+        // Nothing to bind: keep sharing the current values.
+        return;
+    }
+
+    ctx.values = statement_values_modify(self, cassandra_statement, ctx.owner->parameter_count);
+
+    if (RB_TYPE_P(values, T_ARRAY)) {
+        // Positional values bind exactly one parameter each.
+        for (long i = 0; i < RARRAY_LEN(values); i++) {
+            statement_bind_value(&ctx, &ctx.owner->parameters[i], RARRAY_AREF(values, i));
+        }
+    } else {
+        rb_hash_foreach(values, hash_cb, (VALUE)&ctx);
+    }
+}
+
 /**
  * Binds a specified column value to a query.
- * A hash object should be given with column name as key.
+ * A hash object should be given with column name as key,
+ * or an array object with values in the order of the query's parameters.
  *
- * @param hash [Hash] A hash object to bind.
+ * @param values [Hash, Array] A hash or an array object to bind.
  * @return [Cassandra::Statement] self.
  * @raise [RangeError] If an invalid range of values was given.
  * @raise [TypeError] If an invalid type of values was given.
+ * @raise [ArgumentError] If more values than parameters were given.
  * @raise [Cassandra::StatementError] If an invalid column name was given.
  */
-static VALUE statement_bind(VALUE self, VALUE hash)
+static VALUE statement_bind(VALUE self, VALUE values)
+{
+    CassandraStatement *cassandra_statement;
+
+    GET_STATEMENT(self, cassandra_statement);
+
+    statement_bind_values(self, cassandra_statement, values);
+    return self;
+}
+
+/**
+ * Returns a new statement bound with the given values, leaving self untouched.
+ * The new statement shares the prepared query with self, so it needs no
+ * prepare round-trip. Values, page size and idempotency already set on self are
+ * carried over. Use one per concurrent execution to drive many
+ * +Cassandra::Session#execute_async+ calls from a single prepared statement.
+ *
+ * @param values [Hash, Array] A hash or an array object to bind.
+ * @return [Cassandra::Statement] A new statement.
+ * @raise [RangeError] If an invalid range of values was given.
+ * @raise [TypeError] If an invalid type of values was given.
+ * @raise [ArgumentError] If more values than parameters were given.
+ * @raise [Cassandra::StatementError] If an invalid column name was given.
+ */
+VALUE statement_bind_new(VALUE self, VALUE values)
+{
+    CassandraStatement *cassandra_statement;
+    CassandraStatement *bound_statement;
+    VALUE bound_statement_obj;
+
+    if (!RB_TYPE_P(values, T_HASH) && !RB_TYPE_P(values, T_ARRAY)) {
+        rb_raise(rb_eTypeError, "wrong argument type %"PRIsVALUE" (expected Hash or Array)", rb_obj_class(values));
+    }
+    GET_STATEMENT(self, cassandra_statement);
+
+    bound_statement_obj = CREATE_STATEMENT(bound_statement);
+    bound_statement->prepared = cassandra_statement->prepared;
+    RB_OBJ_WRITE(bound_statement_obj, &bound_statement->prepared_obj,
+                 cassandra_statement->prepared_obj ? cassandra_statement->prepared_obj : self);
+    RB_OBJ_WRITE(bound_statement_obj, &bound_statement->session_obj, cassandra_statement->session_obj);
+    // Share the bound values until either statement binds again.
+    statement_values_retain(cassandra_statement->bound_values);
+    bound_statement->bound_values = cassandra_statement->bound_values;
+    bound_statement->page_size = cassandra_statement->page_size;
+    bound_statement->idempotent = cassandra_statement->idempotent;
+    if (cassandra_statement->paging_state) {
+        RB_OBJ_WRITE(bound_statement_obj, &bound_statement->paging_state, cassandra_statement->paging_state);
+    }
+
+    statement_bind_values(bound_statement_obj, bound_statement, values);
+    return bound_statement_obj;
+}
+
+/*
+ * Returns the index of the parameter named +name+, using the same name rules
+ * as binding.
+ */
+size_t statement_parameter_index(VALUE self, VALUE name)
 {
     CassandraStatement *cassandra_statement;
     statement_bind_context ctx;
-    VALUE bound_values;
 
-    Check_Type(hash, T_HASH);
-    TypedData_Get_Struct(self, CassandraStatement, &cassandra_statement_data_type, cassandra_statement);
+    GET_STATEMENT(self, cassandra_statement);
+    ctx.self = self;
+    ctx.owner = statement_owner(cassandra_statement);
+    ctx.values = NULL;
+    ctx.cursor = 0;
+    return statement_find_parameter(&ctx, name)->index;
+}
 
-    // Merge into a copy instead of mutating in place: the previous hash may be
-    // shared with a frozen (Ractor-shareable) statement or be iterated by an
-    // execution on another thread.
-    if (NIL_P(cassandra_statement->bound_values)) {
-        bound_values = rb_hash_new();
-    } else {
-        bound_values = rb_hash_dup(cassandra_statement->bound_values);
+/*
+ * Appends the encoded value bound to the parameter at +index+ to +buffer+, so
+ * that statements bound with equal values produce equal bytes.
+ */
+void statement_append_value_key(VALUE self, size_t index, VALUE buffer)
+{
+    CassandraStatement *cassandra_statement;
+    const statement_value *value;
+    char state;
+
+    GET_STATEMENT(self, cassandra_statement);
+    if (!cassandra_statement->bound_values) {
+        state = statement_value_unset;
+        rb_str_buf_cat(buffer, &state, 1);
+        return;
+    }
+
+    value = &cassandra_statement->bound_values->values[index];
+    state = (char)value->state;
+    rb_str_buf_cat(buffer, &state, 1);
+    if (value->state != statement_value_set) {
+        return;
     }
-    RB_OBJ_WRITE(self, &cassandra_statement->bound_values, bound_values);
 
-    ctx.prepared = cassandra_statement->prepared;
-    ctx.statement = cassandra_statement->statement;
-    ctx.bound_values = bound_values;
+    if (value->object) {
+        const char *bytes = NULL;
+        size_t length = 0;
 
-    rb_hash_foreach(hash, hash_cb, (VALUE)&ctx);
-    return self;
+        statement_value_bytes(value, &bytes, &length);
+        rb_str_buf_cat(buffer, (const char *)&length, sizeof(length));
+        rb_str_buf_cat(buffer, bytes, length);
+        return;
+    }
+
+    switch (statement_owner(cassandra_statement)->parameters[index].type) {
+    case CASS_VALUE_TYPE_FLOAT:
+    case CASS_VALUE_TYPE_DOUBLE:
+        rb_str_buf_cat(buffer, (const char *)&value->as.floating, sizeof(value->as.floating));
+        break;
+    case CASS_VALUE_TYPE_BOOLEAN:
+        rb_str_buf_cat(buffer, (const char *)&value->as.boolean, sizeof(value->as.boolean));
+        break;
+    case CASS_VALUE_TYPE_UUID:
+        rb_str_buf_cat(buffer, (const char *)&value->as.uuid.time_and_version, sizeof(value->as.uuid.time_and_version));
+        rb_str_buf_cat(buffer, (const char *)&value->as.uuid.clock_seq_and_node, sizeof(value->as.uuid.clock_seq_and_node));
+        break;
+    default:
+        rb_str_buf_cat(buffer, (const char *)&value->as.integer, sizeof(value->as.integer));
+    }
 }
 
 /**
@@ -267,7 +750,6 @@ static VALUE statement_page_size(VALUE self, VALUE page_size)
 
     GET_STATEMENT(self, cassandra_statement);
     cassandra_statement->page_size = NUM2INT(page_size);
-    cass_statement_set_paging_size(cassandra_statement->statement, cassandra_statement->page_size);
     return self;
 }
 
@@ -285,41 +767,94 @@ static VALUE statement_idempotent(VALUE self, VALUE idempotent)
 
     GET_STATEMENT(self, cassandra_statement);
     cassandra_statement->idempotent = RTEST(idempotent) ? idempotency_true : idempotency_false;
-    cass_statement_set_is_idempotent(cassandra_statement->statement, cassandra_statement->idempotent == idempotency_true ? cass_true : cass_false);
+    return self;
+}
+
+/**
+ * Sets the paging state to resume paging from, as returned by
+ * +Cassandra::Result#paging_state+. Executions of the statement then start
+ * from the page following the one the token was taken from.
+ * The default is +nil+, which starts from the first page.
+ *
+ * @param paging_state [String, nil] A paging state token.
+ * @return [Cassandra::Statement] self.
+ * @raise [TypeError] If the invalid object is given.
+ */
+static VALUE statement_paging_state(VALUE self, VALUE paging_state)
+{
+    CassandraStatement *cassandra_statement;
+
+    GET_STATEMENT(self, cassandra_statement);
+    if (NIL_P(paging_state)) {
+        cassandra_statement->paging_state = 0;
+    } else {
+        RB_OBJ_WRITE(self, &cassandra_statement->paging_state, statement_string_snapshot(paging_state));
+    }
     return self;
 }
 
 static void statement_mark(void *ptr)
 {
     CassandraStatement *cassandra_statement = (CassandraStatement *)ptr;
+    rb_gc_mark_movable(cassandra_statement->prepared_obj);
     rb_gc_mark_movable(cassandra_statement->session_obj);
-    rb_gc_mark_movable(cassandra_statement->bound_values);
+    rb_gc_mark_movable(cassandra_statement->paging_state);
+    if (cassandra_statement->bound_values) {
+        statement_values *values = cassandra_statement->bound_values;
+
+        for (size_t i = 0; i < values->count; i++) {
+            rb_gc_mark_movable(values->values[i].object);
+        }
+    }
 }
 
 static void statement_destroy(void *ptr)
 {
     CassandraStatement *cassandra_statement = (CassandraStatement *)ptr;
 
-    if (cassandra_statement->prepared) {
+    if (cassandra_statement->prepared && !cassandra_statement->prepared_obj) {
         cass_prepared_free(cassandra_statement->prepared);
     }
-    if (cassandra_statement->statement) {
-        cass_statement_free(cassandra_statement->statement);
-    }
+    statement_values_release(cassandra_statement->bound_values);
+    xfree(cassandra_statement->parameters);
     xfree(cassandra_statement);
 }
 
 static size_t statement_memsize(const void *ptr)
 {
-    return sizeof(CassandraStatement);
+    const CassandraStatement *cassandra_statement = (const CassandraStatement *)ptr;
+    const statement_values *values = cassandra_statement->bound_values;
+    size_t size = sizeof(CassandraStatement);
+
+    if (cassandra_statement->parameters) {
+        size += cassandra_statement->parameter_count * sizeof(statement_parameter);
+    }
+
+    // Bound values shared by Statement#bind_new are split between the
+    // statements sharing them. The Strings holding their bytes are objects of
+    // their own.
+    if (values) {
+        size += (sizeof(statement_values) + values->count * sizeof(statement_value)) / (values->refcount > 0 ? values->refcount : 1);
+    }
+    return size;
 }
 
 static void statement_compact(void *ptr)
 {
     CassandraStatement *cassandra_statement = (CassandraStatement *)ptr;
 
+    cassandra_statement->prepared_obj = rb_gc_location(cassandra_statement->prepared_obj);
     cassandra_statement->session_obj = rb_gc_location(cassandra_statement->session_obj);
-    cassandra_statement->bound_values = rb_gc_location(cassandra_statement->bound_values);
+    if (cassandra_statement->paging_state) {
+        cassandra_statement->paging_state = rb_gc_location(cassandra_statement->paging_state);
+    }
+    if (cassandra_statement->bound_values) {
+        statement_values *values = cassandra_statement->bound_values;
+
+        for (size_t i = 0; i < values->count; i++) {
+            values->values[i].object = rb_gc_location(values->values[i].object);
+        }
+    }
 }
 
 void Init_statement(void)
@@ -327,6 +862,8 @@ void Init_statement(void)
     rb_undef_alloc_func(cStatement);
 
     rb_define_method(cStatement, "bind", statement_bind, 1);
+    rb_define_method(cStatement, "bind_new", statement_bind_new, 1);
     rb_define_method(cStatement, "page_size=", statement_page_size, 1);
     rb_define_method(cStatement, "idempotent=", statement_idempotent, 1);
+    rb_define_method(cStatement, "paging_state=", statement_paging_state, 1);
 }
@@ -20,6 +20,45 @@ module Ilios
   end
 end
 
+# A minimal fiber scheduler which only supports waiting for readable IOs,
+# enough to check that awaiting yields to other fibers.
+class TestFiberScheduler
+  def initialize
+    @readable = {}
+  end
+
+  def fiber(&block)
+    fiber = Fiber.new(blocking: false, &block)
+    fiber.resume
+    fiber
+  end
+
+  def io_wait(io, events, _timeout)
+    @readable[io] = Fiber.current
+    Fiber.yield
+    events
+  end
+
+  def block(_blocker, _timeout = nil)
+    raise NotImplementedError
+  end
+
+  def unblock(_blocker, _fiber)
+    raise NotImplementedError
+  end
+
+  def kernel_sleep(*)
+    raise NotImplementedError
+  end
+
+  def close
+    until @readable.empty?
+      readable, = IO.select(@readable.keys)
+      readable.each { |io| @readable.delete(io).resume }
+    end
+  end
+end
+
 def prepare_keyspace
   cluster = Ilios::Cassandra::Cluster.new
   cluster.hosts([CASSANDRA_HOST])
@@ -55,6 +94,7 @@ def prepare_table
       text text,
       timestamp timestamp,
       uuid uuid,
+      blob blob,
       PRIMARY KEY (id)
     ) WITH compaction = { 'class' : 'LeveledCompactionStrategy' }
     AND gc_grace_seconds = 691200;
@@ -0,0 +1,84 @@
+# frozen_string_literal: true
+
+require_relative 'helper'
+
+class BatchTest < Minitest::Test
+  def setup
+    @insert_statement = Ilios::Cassandra.session.prepare(<<~CQL)
+      INSERT INTO ilios.test (id, text) VALUES (?, ?);
+    CQL
+    @select_statement = Ilios::Cassandra.session.prepare(<<~CQL)
+      SELECT * FROM ilios.test WHERE id = ?;
+    CQL
+  end
+
+  def test_new
+    assert_kind_of(Ilios::Cassandra::Batch, Ilios::Cassandra::Batch.new)
+    assert_kind_of(Ilios::Cassandra::Batch, Ilios::Cassandra::Batch.new(Ilios::Cassandra::Batch::UNLOGGED))
+    assert_raises(ArgumentError) { Ilios::Cassandra::Batch.new(100) }
+  end
+
+  def test_allocate
+    batch = Ilios::Cassandra::Batch.allocate
+
+    assert_equal(0, batch.size)
+    assert_same(batch, batch.add(@insert_statement, { id: 1, text: 'batch' }))
+    assert_equal(1, batch.size)
+  end
+
+  def test_add
+    batch = Ilios::Cassandra::Batch.new
+
+    assert_raises(TypeError) { batch.add(Object.new) }
+    assert_raises(Ilios::Cassandra::StatementError) { batch.add(@insert_statement, { foo: 1 }) }
+
+    assert_same(batch, batch.add(@insert_statement, { id: 1, text: 'batch' }))
+    assert_same(batch, batch.add(@insert_statement, [2, 'batch']))
+    assert_equal(2, batch.size)
+  end
+
+  def test_execute_batch
+    id = Random.rand(2**40)
+    batch = Ilios::Cassandra::Batch.new
+    batch.consistency = Ilios::Cassandra::CONSISTENCY_ONE
+    batch.idempotent = true
+
+    @insert_statement.bind({ id: id, text: 'first' })
+    batch.add(@insert_statement)
+    # Re-binding after add must not change the statement already in the batch.
+    @insert_statement.bind({ id: id + 1, text: 'second' })
+    batch.add(@insert_statement)
+    @insert_statement.bind({ id: id + 2, text: 'never added' })
+
+    assert_raises(TypeError) { Ilios::Cassandra.session.execute_batch(Object.new) }
+
+    result = Ilios::Cassandra.session.execute_batch(batch)
+
+    assert_kind_of(Ilios::Cassandra::Result, result)
+    assert_nil(result.next_page)
+
+    assert_equal('first', Ilios::Cassandra.session.execute(@select_statement.bind([id])).first['text'])
+    assert_equal('second', Ilios::Cassandra.session.execute(@select_statement.bind([id + 1])).first['text'])
+    assert_nil(Ilios::Cassandra.session.execute(@select_statement.bind([id + 2])).first)
+  end
+
+  def test_execute_batch_async
+    id = Random.rand(2**40)
+    batch = Ilios::Cassandra::Batch.new(Ilios::Cassandra::Batch::UNLOGGED)
+    batch.add(@insert_statement, { id: id, text: 'async' })
+
+    future = Ilios::Cassandra.session.execute_batch_async(batch)
+
+    assert_kind_of(Ilios::Cassandra::Future, future)
+
+    success_count = 0
+    future.on_success do |result|
+      assert_kind_of(Ilios::Cassandra::Result, result)
+      success_count += 1
+    end
+    future.await
+
+    assert_equal(1, success_count)
+    assert_equal('async', Ilios::Cassandra.session.execute(@select_statement.bind([id])).first['text'])
+  end
+end
@@ -15,4 +15,14 @@ class CassandraTest < Minitest::Test
     Ilios::Cassandra.log_level(Ilios::Cassandra::LOG_DEBUG)
     pass
   end
+
+  def test_driver_memory_stats
+    Ilios::Cassandra.session.execute(Ilios::Cassandra.session.prepare('SELECT * FROM ilios.test LIMIT 1;'))
+
+    stats = Ilios::Cassandra.driver_memory_stats
+
+    assert_equal(%i[allocated_bytes allocations frees], stats.keys)
+    assert_operator(stats[:allocations], :>=, stats[:frees])
+    assert_operator(Ilios::Cassandra.driver_memory_stats[:allocations], :>=, stats[:allocations])
+  end
 end
@@ -0,0 +1,58 @@
+# frozen_string_literal: true
+
+require_relative 'helper'
+
+class CompletionQueueTest < Minitest::Test
+  def setup
+    @statement = Ilios::Cassandra.session.prepare('SELECT * FROM ilios.test LIMIT 1;')
+  end
+
+  def test_drain
+    queue = Ilios::Cassandra::CompletionQueue.new
+    thread = nil
+    futures = Array.new(10) do
+      future = Ilios::Cassandra.session.execute_async(@statement)
+      future.on_success { thread = Thread.current }
+      queue.attach(future)
+      future
+    end
+
+    drained = []
+    while drained.size < futures.size
+      IO.select([queue], nil, nil, 10)
+      drained.concat(queue.drain(max: 3))
+    end
+
+    assert_equal(futures.sort_by(&:object_id), drained.sort_by(&:object_id))
+    assert_equal(Thread.current, thread)
+    assert_empty(queue.drain)
+    assert_nil(IO.select([queue], nil, nil, 0))
+  end
+
+  def test_drain_with_max
+    queue = Ilios::Cassandra::CompletionQueue.new
+    futures = Array.new(3) { Ilios::Cassandra.session.execute_async(@statement) }
+    futures.each { |future| queue.attach(future) }
+
+    drained = []
+    while drained.size < futures.size
+      # Stays readable while futures are left after a drain.
+      assert(IO.select([queue], nil, nil, 10))
+
+      batch = queue.drain(max: 1)
+
+      assert_operator(batch.size, :<=, 1)
+      drained.concat(batch)
+    end
+  end
+
+  def test_attach
+    queue = Ilios::Cassandra::CompletionQueue.new
+    future = Ilios::Cassandra.session.execute_async(@statement)
+    future.on_success {}
+
+    assert_raises(Ilios::Cassandra::ExecutionError) { queue.attach(future) }
+    assert_raises(ArgumentError) { queue.drain(max: 0) }
+    assert_raises(TypeError) { queue.attach(Object.new) }
+  end
+end
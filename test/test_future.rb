@@ -70,6 +70,145 @@ class FutureTest < Minitest::Test
     end
   end
 
+  def test_on_success_many_in_flight
+    statement = Ilios::Cassandra.session.prepare('SELECT * FROM ilios.test LIMIT 1;')
+    count = 0
+    mutex = Mutex.new
+
+    # More in-flight callbacks than the yielder threads and queue used to hold.
+    futures = Array.new(300) do
+      future = Ilios::Cassandra.session.execute_async(statement)
+      future.on_success do |result|
+        assert_kind_of(Ilios::Cassandra::Result, result)
+        mutex.synchronize { count += 1 }
+      end
+      future
+    end
+    futures.each(&:await)
+
+    assert_equal(300, count)
+  end
+
+  def test_await_recycled
+    statement = Ilios::Cassandra.session.prepare('SELECT * FROM ilios.test LIMIT 1;')
+
+    # more futures than are kept for reuse, collected in between
+    3.times do
+      futures = Array.new(300) { Ilios::Cassandra.session.execute_async(statement) }
+      futures.each(&:await)
+
+      assert(futures.all? { |future| future.await.equal?(future) })
+      futures.clear
+      GC.start
+    end
+
+    called = false
+    future = Ilios::Cassandra.session.execute_async(statement)
+    future.await
+    future.on_success { called = true }
+
+    assert(called)
+  end
+
+  def test_await_all_and_any
+    statement = Ilios::Cassandra.session.prepare('SELECT * FROM ilios.test LIMIT 1;')
+    futures = Array.new(100) { Ilios::Cassandra.session.execute_async(statement) }
+    count = 0
+    futures[0].on_success { count += 1 }
+
+    assert_equal(futures, Ilios::Cassandra::Future.await_all(futures))
+    assert_equal(1, count)
+
+    futures = Array.new(10) { Ilios::Cassandra.session.execute_async(statement) }
+    future = Ilios::Cassandra::Future.await_any(futures, timeout: 10)
+
+    assert_includes(futures, future)
+    assert_equal(futures, Ilios::Cassandra::Future.await_all(futures, timeout: 10))
+
+    assert_empty(Ilios::Cassandra::Future.await_all([]))
+    assert_nil(Ilios::Cassandra::Future.await_any([]))
+    assert_raises(TypeError) { Ilios::Cassandra::Future.await_all([Object.new]) }
+    assert_raises(ArgumentError) { Ilios::Cassandra::Future.await_any(futures, timeout: -1) }
+  end
+
+  def test_await_with_fiber_scheduler
+    session = Ilios::Cassandra.session
+    statement = session.prepare('SELECT * FROM ilios.test LIMIT 1;')
+    order = []
+
+    Thread.new do
+      Fiber.set_scheduler(TestFiberScheduler.new)
+      Fiber.schedule do
+        order << :execute
+        session.execute(statement)
+        order << :executed
+      end
+      Fiber.schedule do
+        order << :await
+        session.execute_async(statement).await
+        order << :awaited
+      end
+      order << :scheduled
+    end.join
+
+    # Both fibers were suspended while their queries ran.
+    assert_equal(%i[execute await scheduled], order.first(3))
+    assert_equal(%i[awaited executed], order.last(2).sort)
+  end
+
+  def test_await_same_future_from_fibers
+    session = Ilios::Cassandra.session
+    statement = session.prepare('SELECT * FROM ilios.test LIMIT 1;')
+    awaited = []
+
+    Thread.new do
+      Fiber.set_scheduler(TestFiberScheduler.new)
+      future = session.execute_async(statement)
+      3.times do |i|
+        Fiber.schedule do
+          future.await
+          awaited << i
+        end
+      end
+      # The pipes of the first round are reused.
+      Fiber.schedule { session.execute_async(statement).await }
+    end.join
+
+    # Every fiber waiting for the future was woken.
+    assert_equal([0, 1, 2], awaited.sort)
+  end
+
+  def test_then_map_rescue
+    session = Ilios::Cassandra.session
+    select = session.prepare('SELECT * FROM ilios.test WHERE id = ?;')
+    insert = session.prepare('INSERT INTO ilios.test (id, text) VALUES (?, ?);')
+    session.execute(insert.bind_new({ id: 9000, text: 'source' }))
+
+    # Read a row, then write a row derived from it.
+    future = session.execute_async(select.bind_new({ id: 9000 }))
+                    .then { |result| session.execute_async(insert.bind_new({ id: 9001, text: "#{result.first['text']}!" })) }
+                    .then { session.execute_async(select.bind_new({ id: 9001 })) }
+                    .map { |result| result.first['text'] }
+
+    assert_equal('source!', future.value)
+    assert_equal([future], Ilios::Cassandra::Future.await_all([future]))
+
+    called = nil
+    failed = session.prepare_async('SELECT * FROM ilios.unknown;')
+                    .map { flunk('skipped on failure') }
+                    .rescue { |error| error.class }
+    failed.on_success { |value| called = value }
+
+    assert_equal(Ilios::Cassandra::ExecutionError, failed.value)
+    assert_equal(Ilios::Cassandra::ExecutionError, called)
+
+    raising = session.execute_async(select.bind_new({ id: 9000 })).map { raise ArgumentError, 'oops' }
+
+    assert_raises(ArgumentError) { raising.value }
+    assert_raises(Ilios::Cassandra::ExecutionError) { session.prepare_async('SELECT * FROM ilios.unknown;').value }
+    assert_raises(ArgumentError) { future.then }
+  end
+
   def test_on_success
     statement = Ilios::Cassandra.session.prepare('SELECT * FROM ilios.test;')
     future = Ilios::Cassandra.session.execute_async(statement)
@@ -63,6 +63,233 @@ class ResultTest < Minitest::Test
     end
 
     assert_kind_of(Enumerator, results.each)
+
+    # column keys are shared by all rows
+    rows = results.to_a
+
+    rows.first.each_key.zip(rows.last.each_key) do |key, other|
+      assert_predicate(key, :frozen?)
+      assert_same(key, other)
+    end
+  end
+
+  def test_each_row
+    @insert_statement.bind({ id: 100, int: 1, text: 'row' })
+    Ilios::Cassandra.session.execute(@insert_statement)
+
+    statement = Ilios::Cassandra.session.prepare('SELECT id, int, text, bigint FROM ilios.test WHERE id = 100;')
+    results = Ilios::Cassandra.session.execute(statement)
+
+    assert_raises(ArgumentError) { results.each_row(as: :foo) {} }
+    assert_kind_of(Enumerator, results.each_row(as: :array))
+
+    # rubocop:disable Style/StringHashKeys
+    assert_equal([{ 'id' => 100, 'int' => 1, 'text' => 'row', 'bigint' => nil }], results.each_row.to_a)
+    # rubocop:enable Style/StringHashKeys
+    assert_equal([[100, 1, 'row', nil]], results.each_row(as: :array).to_a)
+
+    row = results.each_row(as: :struct).first
+
+    assert_kind_of(Struct, row)
+    assert_equal(%i[id int text bigint], row.members)
+    assert_equal(100, row.id)
+    assert_equal('row', row.text)
+    assert_nil(row.bigint)
+
+    # the Struct class is created once per result
+    assert_same(row.class, results.each_row(as: :struct).first.class)
+    assert_same(row.class, results.rows(as: :struct).first.class)
+
+    # column names which can't be Struct members
+    statement = Ilios::Cassandra.session.prepare('SELECT id, id FROM ilios.test WHERE id = 100;')
+    error = assert_raises(ArgumentError) { Ilios::Cassandra.session.execute(statement).each_row(as: :struct) {} }
+    assert_match(/Duplicate column "id"/, error.message)
+
+    statement = Ilios::Cassandra.session.prepare('SELECT writetime(text) FROM ilios.test WHERE id = 100;')
+    error = assert_raises(ArgumentError) { Ilios::Cassandra.session.execute(statement).rows(as: :struct) }
+    assert_match(/not a valid Struct member name/, error.message)
+  end
+
+  def test_columns
+    3.times do |i|
+      @insert_statement.bind({ id: 200 + i, int: i, bigint: i * 10, double: i + 0.5, text: "column #{i}" })
+      Ilios::Cassandra.session.execute(@insert_statement)
+    end
+    @insert_statement.bind({ id: 203, int: nil, bigint: nil, double: nil, text: nil })
+    Ilios::Cassandra.session.execute(@insert_statement)
+
+    statement = Ilios::Cassandra.session.prepare(<<~CQL)
+      SELECT id, int, bigint, double, text FROM ilios.test WHERE id IN (200, 201, 202, 203);
+    CQL
+    results = Ilios::Cassandra.session.execute(statement)
+
+    columns = results.columns
+
+    assert_equal(%w[id int bigint double text], columns.keys)
+    assert_equal([200, 201, 202, 203], columns['id'])
+    assert_equal([0, 1, 2, nil], columns['int'])
+    assert_equal(['column 0', 'column 1', 'column 2', nil], columns['text'])
+
+    assert_equal([0, 10, 20, nil], results.column('bigint'))
+    assert_equal([0, 10, 20, nil], results.column(:bigint))
+    assert_raises(ArgumentError) { results.column(:foo) }
+
+    assert_equal([0, 1, 2, 0], results.column(:int, packed: true).unpack('l*'))
+    assert_equal([0, 10, 20, 0], results.column(:bigint, packed: true).unpack('q*'))
+    assert_equal([0.5, 1.5, 2.5, 0.0], results.column(:double, packed: true).unpack('d*'))
+    assert_raises(TypeError) { results.column(:text, packed: true) }
+
+    if defined?(IO::Buffer)
+      buffer = IO::Buffer.new(32)
+
+      assert_same(buffer, results.column(:bigint, into: buffer))
+      assert_equal([0, 10, 20, 0], buffer.get_string.unpack('q*'))
+      assert_raises(ArgumentError) { results.column(:bigint, into: IO::Buffer.new(8)) }
+    end
+  end
+
+  def test_each_only_and_pluck
+    @insert_statement.bind({ id: 500, int: 5, bigint: 50, text: 'pluck' })
+    Ilios::Cassandra.session.execute(@insert_statement)
+    @insert_statement.bind({ id: 501, int: 6, bigint: nil, text: 'pluck' })
+    Ilios::Cassandra.session.execute(@insert_statement)
+
+    statement = Ilios::Cassandra.session.prepare('SELECT id, int, bigint, text FROM ilios.test WHERE id IN (500, 501);')
+    results = Ilios::Cassandra.session.execute(statement)
+
+    # rubocop:disable Style/StringHashKeys
+    assert_equal([{ 'id' => 500, 'bigint' => 50 }, { 'id' => 501, 'bigint' => nil }], results.each(only: %i[id bigint]).to_a)
+    assert_equal([{ 'text' => 'pluck' }, { 'text' => 'pluck' }], results.each(only: 'text').to_a)
+    # rubocop:enable Style/StringHashKeys
+    assert_raises(ArgumentError) { results.each(only: [:foo]) {} }
+
+    assert_equal([500, 501], results.pluck(:id))
+    assert_equal([[5, 50], [6, nil]], results.pluck('int', :bigint))
+    assert_raises(ArgumentError) { results.pluck }
+    assert_raises(ArgumentError) { results.pluck(:foo) }
+  end
+
+  def test_each_lazy
+    3.times do |i|
+      @insert_statement.bind({ id: 600 + i, int: i, bigint: nil, text: "lazy #{i}" })
+      Ilios::Cassandra.session.execute(@insert_statement)
+    end
+
+    statement = Ilios::Cassandra.session.prepare('SELECT id, int, bigint, text FROM ilios.test WHERE id IN (600, 601, 602);')
+    statement.page_size = 2
+    results = Ilios::Cassandra.session.execute(statement)
+
+    assert_kind_of(Enumerator, results.each_lazy)
+
+    rows = results.each_lazy.select { |row| row[:int].odd? }
+
+    assert_equal(1, rows.size)
+    assert_kind_of(Ilios::Cassandra::Row, rows[0])
+    assert_equal(601, rows[0]['id'])
+    assert_equal(601, rows[0][0])
+    assert_equal('lazy 1', rows[0][-1])
+    assert_nil(rows[0][:bigint])
+    assert_same(rows[0][:text], rows[0][:text])
+    # rubocop:disable Style/StringHashKeys
+    assert_equal({ 'id' => 601, 'int' => 1, 'bigint' => nil, 'text' => 'lazy 1' }, rows[0].to_h)
+    # rubocop:enable Style/StringHashKeys
+    assert_equal([601, 1, nil, 'lazy 1'], rows[0].to_a)
+    assert_raises(ArgumentError) { rows[0][:foo] }
+    assert_raises(IndexError) { rows[0][4] }
+
+    row = results.each_lazy.first
+    id = row[:id]
+    results.next_page
+
+    # values read before the page was replaced are kept
+    assert_equal(id, row[:id])
+    assert_raises(Ilios::Cassandra::ExecutionError) { row[:text] }
+  end
+
+  def test_view_threshold
+    skip 'IO::Buffer is not available' unless defined?(IO::Buffer)
+
+    @insert_statement.bind({ id: 700, text: 'short', blob: 'b' * 100 })
+    Ilios::Cassandra.session.execute(@insert_statement)
+    @insert_statement.bind({ id: 701, text: 'long' * 100, blob: nil })
+    Ilios::Cassandra.session.execute(@insert_statement)
+
+    statement = Ilios::Cassandra.session.prepare('SELECT id, text, blob FROM ilios.test WHERE id IN (700, 701);')
+    statement.page_size = 1
+    results = Ilios::Cassandra.session.execute(statement)
+
+    assert_nil(results.view_threshold)
+    results.view_threshold = 64
+
+    assert_equal(64, results.view_threshold)
+    assert_raises(ArgumentError) { results.view_threshold = -1 }
+
+    row = results.each_row(as: :array).first
+
+    assert_equal('short', row[1])
+    assert_kind_of(IO::Buffer, row[2])
+    assert_predicate(row[2], :readonly?)
+    assert_equal('b' * 100, row[2].get_string)
+
+    results.next_page
+    GC.start
+
+    # views stay valid after the page was replaced
+    assert_equal('b' * 100, row[2].get_string)
+    assert_equal('long' * 100, results.pluck(:text).first.get_string)
+
+    results.view_threshold = nil
+
+    assert_equal('long' * 100, results.pluck(:text).first)
+  end
+
+  def test_memsize_and_release
+    require 'objspace'
+
+    @insert_statement.bind({ id: 800, text: 'x' * 100_000 })
+    Ilios::Cassandra.session.execute(@insert_statement)
+
+    statement = Ilios::Cassandra.session.prepare('SELECT id, text FROM ilios.test WHERE id = ?;')
+    statement.bind([800])
+    results = Ilios::Cassandra.session.execute(statement)
+
+    assert_operator(ObjectSpace.memsize_of(results), :>, 100_000)
+
+    row = results.each_lazy.first
+    id = row[:id]
+
+    # the page can't be freed under an iteration
+    assert_raises(Ilios::Cassandra::ExecutionError) { results.each { results.release } }
+    assert_raises(Ilios::Cassandra::ExecutionError) { results.each_lazy { results.release } }
+    assert_raises(Ilios::Cassandra::ExecutionError) { results.each_row(as: :array) { results.next_page } }
+
+    assert_nil(results.release)
+    assert_equal(id, row[:id])
+    assert_raises(Ilios::Cassandra::ExecutionError) { row[:text] }
+    assert_raises(Ilios::Cassandra::ExecutionError) { results.to_a }
+    assert_raises(Ilios::Cassandra::ExecutionError) { results.next_page }
+    assert_operator(ObjectSpace.memsize_of(results), :<, 100_000)
+  end
+
+  def test_rows
+    10.times do |i|
+      @insert_statement.bind({ id: 400 + i, int: i, bigint: i * 10, double: i + 0.5, text: "rows #{i}" })
+      Ilios::Cassandra.session.execute(@insert_statement)
+    end
+    @insert_statement.bind({ id: 410, int: nil, bigint: nil, double: nil, text: nil })
+    Ilios::Cassandra.session.execute(@insert_statement)
+
+    statement = Ilios::Cassandra.session.prepare(<<~CQL)
+      SELECT id, int, bigint, double, text FROM ilios.test WHERE id IN (400, 401, 402, 403, 404, 405, 406, 407, 408, 409, 410);
+    CQL
+    results = Ilios::Cassandra.session.execute(statement)
+
+    assert_equal(results.to_a, results.rows)
+    assert_equal(results.each_row(as: :array).to_a, results.rows(as: :array))
+    assert_equal(results.each_row(as: :struct).to_a, results.rows(as: :struct))
+    assert_equal([nil, nil, nil, nil], results.rows(as: :array).last.drop(1))
+
+    assert_raises(ArgumentError) { results.rows(as: :foo) }
   end
 
   def test_next_page
@@ -109,6 +336,102 @@ class ResultTest < Minitest::Test
     assert_nil(results.next_page) # no more pages
   end
 
+  def test_each_page
+    statement = Ilios::Cassandra.session.prepare('SELECT id FROM ilios.test;')
+    statement.page_size = 3
+
+    results = Ilios::Cassandra.session.execute(statement)
+    expected = results.map { |row| row['id'] }
+    expected.concat(results.map { |row| row['id'] }) while results.next_page
+
+    [0, 1, 3].each do |prefetch|
+      results = Ilios::Cassandra.session.execute(statement)
+      ids = []
+      pages = 0
+      results.each_page(prefetch: prefetch) do |page|
+        assert_same(results, page)
+        assert_raises(Ilios::Cassandra::ExecutionError) { page.next_page }
+        ids.concat(page.map { |row| row['id'] })
+        pages += 1
+      end
+
+      assert_equal(expected, ids)
+      assert_equal((expected.size / 3.0).ceil, pages) unless (expected.size % 3).zero?
+
+      rows = Ilios::Cassandra.session.execute(statement).each_all(prefetch: prefetch, as: :array).to_a
+
+      assert_equal(expected, rows.map(&:first))
+    end
+
+    # stopping early leaves the result usable
+    results = Ilios::Cassandra.session.execute(statement)
+    results.each_page { break }
+
+    assert_kind_of(Ilios::Cassandra::Result, results.next_page)
+    assert_raises(ArgumentError) { results.each_page(prefetch: -1) {} }
+  end
+
+  def test_next_page_async
+    statement = Ilios::Cassandra.session.prepare('SELECT id FROM ilios.test;')
+    statement.page_size = 3
+
+    results = Ilios::Cassandra.session.execute(statement)
+    expected = results.map { |row| row['id'] }
+    expected.concat(results.map { |row| row['id'] }) while results.next_page
+
+    results = Ilios::Cassandra.session.execute(statement)
+    ids = results.map { |row| row['id'] }
+    page = results
+    while (future = page.next_page_async)
+      assert_kind_of(Ilios::Cassandra::Future, future)
+      # paging was handed over to the future
+      assert_nil(page.next_page)
+
+      next_page = nil
+      future.on_success { |result| next_page = result }
+      future.await
+
+      assert_kind_of(Ilios::Cassandra::Result, next_page)
+      ids.concat(next_page.map { |row| row['id'] })
+      page = next_page
+    end
+
+    assert_equal(expected, ids)
+  end
+
+  def test_paging_state
+    statement = Ilios::Cassandra.session.prepare('SELECT id FROM ilios.test;')
+    statement.page_size = 3
+
+    results = Ilios::Cassandra.session.execute(statement)
+    token = results.paging_state
+
+    assert_kind_of(String, token)
+    assert_equal(Encoding::BINARY, token.encoding)
+
+    results.next_page
+    expected = results.map { |row| row['id'] }
+
+    # resume from the token with a fresh statement
+    resumed = Ilios::Cassandra.session.prepare('SELECT id FROM ilios.test;')
+    resumed.page_size = 3
+
+    assert_same(resumed, resumed.paging_state = token)
+    assert_equal(expected, Ilios::Cassandra.session.execute(resumed).map { |row| row['id'] })
+
+    resumed.paging_state = nil
+
+    assert_equal(
+      Ilios::Cassandra.session.execute(statement).map { |row| row['id'] },
+      Ilios::Cassandra.session.execute(resumed).map { |row| row['id'] }
+    )
+    assert_raises(TypeError) { resumed.paging_state = Object.new }
+
+    statement = Ilios::Cassandra.session.prepare('SELECT * FROM ilios.test WHERE id = -1;')
+
+    assert_nil(Ilios::Cassandra.session.execute(statement).paging_state)
+  end
+
   def test_next_page_failure
     # setup
     statement = Ilios::Cassandra.session.prepare(<<~CQL)
@@ -145,6 +468,35 @@ class ResultTest < Minitest::Test
     assert_equal(5, results.to_a.size)
   end
 
+  def test_counter
+    # setup
+    statement = Ilios::Cassandra.session.prepare(<<~CQL)
+      CREATE TABLE IF NOT EXISTS ilios.counter (id bigint, count counter, PRIMARY KEY (id));
+    CQL
+    Ilios::Cassandra.session.execute(statement)
+
+    statement = Ilios::Cassandra.session.prepare(<<~CQL)
+      UPDATE ilios.counter SET count = count + 5 WHERE id = ?;
+    CQL
+    statement.bind(id: 1)
+    Ilios::Cassandra.session.execute(statement)
+
+    statement = Ilios::Cassandra.session.prepare(<<~CQL)
+      SELECT * FROM ilios.counter;
+    CQL
+    results = Ilios::Cassandra.session.execute(statement)
+
+    assert_equal([{ 'id' => 1, 'count' => 5 }], results.to_a)
+    assert_equal([5], results.column(:count))
+    assert_equal([5], results.column(:count, packed: true).unpack('q*'))
+
+    # teardown
+    statement = Ilios::Cassandra.session.prepare(<<~CQL)
+      DROP TABLE ilios.counter;
+    CQL
+    Ilios::Cassandra.session.execute(statement)
+  end
+
   def test_each_with_short_value
     # setup
     statement = Ilios::Cassandra.session.prepare(<<~CQL)
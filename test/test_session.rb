@@ -90,6 +90,111 @@ class SessionTest < Minitest::Test
     assert_equal(0, failure_count)
   end
 
+  def test_execute_many
+    # invalid statement
+    assert_raises(TypeError) { Ilios::Cassandra.session.execute_many(Object.new, []) }
+    assert_raises(TypeError) { Ilios::Cassandra.session.execute_many(Object.new, [{ id: 1 }]) }
+
+    insert_statement = Ilios::Cassandra.session.prepare('INSERT INTO ilios.test (id, text) VALUES (?, ?);')
+    ids = Array.new(50) { Random.rand(2**60) }
+
+    assert_raises(Ilios::Cassandra::StatementError) do
+      Ilios::Cassandra.session.execute_many(insert_statement, [{ id: 1 }, { foo: 1 }])
+    end
+
+    results = Ilios::Cassandra.session.execute_many(insert_statement, ids.map { |id| [id, "many #{id}"] })
+
+    assert_equal(50, results.size)
+    results.each { |result| assert_kind_of(Ilios::Cassandra::Result, result) }
+
+    select_statement = Ilios::Cassandra.session.prepare('SELECT id, text FROM ilios.test WHERE id = ?;')
+    results = Ilios::Cassandra.session.execute_many(select_statement, ids.map { |id| { id: id } })
+
+    results.zip(ids).each do |result, id|
+      row = result.first
+
+      assert_equal(id, row['id'])
+      assert_equal("many #{id}", row['text'])
+    end
+  end
+
+  def test_execute_many_with_mutating_values
+    insert_statement = Ilios::Cassandra.session.prepare('INSERT INTO ilios.test (id, text) VALUES (?, ?);')
+    values_list = Array.new(10) { |i| [i + 700, "many #{i}"] }
+    text = Object.new
+    text.define_singleton_method(:to_str) do
+      values_list.clear
+      'cleared'
+    end
+    values_list[0][1] = text
+
+    # binding works on a snapshot of the list taken before
+    results = Ilios::Cassandra.session.execute_many(insert_statement, values_list)
+
+    assert_equal(10, results.size)
+    assert_empty(values_list)
+  end
+
+  def test_execute_many_async
+    statement = Ilios::Cassandra.session.prepare('SELECT * FROM ilios.test WHERE id = ?;')
+    futures = Ilios::Cassandra.session.execute_many_async(statement, Array.new(10) { |i| [i] })
+
+    assert_equal(10, futures.size)
+
+    success_count = 0
+    futures.each do |future|
+      assert_kind_of(Ilios::Cassandra::Future, future)
+      future.on_success do |result|
+        assert_kind_of(Ilios::Cassandra::Result, result)
+        success_count += 1
+      end
+    end
+    futures.each(&:await)
+
+    assert_equal(10, success_count)
+  end
+
+  def test_bulk_load
+    insert_statement = Ilios::Cassandra.session.prepare('INSERT INTO ilios.test (id, text) VALUES (?, ?);')
+
+    assert_raises(TypeError) { Ilios::Cassandra.session.bulk_load(Object.new, []) }
+    assert_raises(ArgumentError) { Ilios::Cassandra.session.bulk_load(insert_statement, [], concurrency: 0) }
+    assert_raises(ArgumentError) { Ilios::Cassandra.session.bulk_load(insert_statement, [], batch_size: 0) }
+    assert_raises(Ilios::Cassandra::StatementError) do
+      Ilios::Cassandra.session.bulk_load(insert_statement, [], batch_by_partition: :foo)
+    end
+
+    ids = Array.new(200) { Random.rand(2**60) }
+    rows = Enumerator.new do |y|
+      ids.each { |id| y << [id, "bulk #{id}"] }
+    end
+    summary = Ilios::Cassandra.session.bulk_load(insert_statement, rows, concurrency: 8)
+
+    assert_equal(200, summary[:rows])
+    assert_equal(200, summary[:succeeded])
+    assert_equal(0, summary[:failed])
+    assert_equal(200, summary[:requests])
+    assert_empty(summary[:errors])
+    assert_kind_of(Float, summary[:elapsed])
+
+    select_statement = Ilios::Cassandra.session.prepare('SELECT text FROM ilios.test WHERE id = ?;')
+
+    assert_equal("bulk #{ids.last}", Ilios::Cassandra.session.execute(select_statement.bind([ids.last])).first['text'])
+  end
+
+  def test_bulk_load_batch_by_partition
+    insert_statement = Ilios::Cassandra.session.prepare('INSERT INTO ilios.test (id, text) VALUES (?, ?);')
+    ids = Array.new(3) { Random.rand(2**60) }
+    rows = ids.flat_map { |id| Array.new(10) { |i| { id: id, text: "batch #{i}" } } }
+
+    summary = Ilios::Cassandra.session.bulk_load(insert_statement, rows, batch_by_partition: :id, batch_size: 4)
+
+    assert_equal(30, summary[:rows])
+    assert_equal(30, summary[:succeeded])
+    # Each partition's 10 rows are sent as batches of 4, 4 and 2.
+    assert_equal(9, summary[:requests])
+  end
+
   def test_async
     success_count = 0
 
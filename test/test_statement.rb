@@ -57,6 +57,90 @@ class StatementTest < Minitest::Test
     end
 
     assert_kind_of(Ilios::Cassandra::Statement, @insert_statement.bind({ key => 1 }))
+
+    # names are case-insensitive unless quoted
+    assert_kind_of(Ilios::Cassandra::Statement, @insert_statement.bind({ ID: 1 }))
+    assert_raises(Ilios::Cassandra::StatementError) { @insert_statement.bind({ '"ID"' => 1 }) }
+  end
+
+  def test_bind_array
+    # invalid value
+    assert_raises(ArgumentError) { @insert_statement.bind(Array.new(12, 1)) }
+    assert_raises(RangeError) { @insert_statement.bind([1, 2**7]) }
+
+    # valid values
+    id = Random.rand(2**60)
+    uuid = SecureRandom.uuid
+
+    assert_kind_of(
+      Ilios::Cassandra::Statement,
+      @insert_statement.bind([id, 1, 2, 3, 4, 5.5, 6.5, true, 'hello', Time.now, uuid])
+    )
+    Ilios::Cassandra.session.execute(@insert_statement)
+
+    statement = Ilios::Cassandra.session.prepare('SELECT * FROM ilios.test WHERE id = ?;')
+    row = Ilios::Cassandra.session.execute(statement.bind([id])).first
+
+    assert_equal(3, row['int'])
+    assert_equal('hello', row['text'])
+    assert_equal(uuid, row['uuid'])
+
+    # a prefix of the values can be given, the rest are left as bound
+    @insert_statement.bind([id, 10])
+    Ilios::Cassandra.session.execute(@insert_statement)
+    row = Ilios::Cassandra.session.execute(statement).first
+
+    assert_equal(10, row['tinyint'])
+    assert_equal(3, row['int'])
+  end
+
+  def test_bind_new
+    # invalid value
+    assert_raises(TypeError) { @insert_statement.bind_new(Object.new) }
+    assert_raises(Ilios::Cassandra::StatementError) { @insert_statement.bind_new({ foo: 123 }) }
+    assert_raises(RangeError) { @insert_statement.bind_new(tinyint: 2**7) }
+
+    @insert_statement.bind(text: 'template')
+    ids = Array.new(20) { Random.rand(2**60) }
+    futures = ids.map do |id|
+      bound = @insert_statement.bind_new(id: id, int: id % 1000)
+
+      assert_kind_of(Ilios::Cassandra::Statement, bound)
+      refute_same(@insert_statement, bound)
+
+      # a statement made by bind_new can derive further statements
+      Ilios::Cassandra.session.execute_async(bound.bind_new(tinyint: 1))
+    end
+    futures.each(&:await)
+
+    statement = Ilios::Cassandra.session.prepare(<<~CQL)
+      SELECT * FROM ilios.test WHERE id IN (#{ids.join(', ')});
+    CQL
+    rows = Ilios::Cassandra.session.execute(statement).to_a
+
+    assert_equal(20, rows.size)
+    rows.each do |row|
+      assert_equal(row['id'] % 1000, row['int'])
+      assert_equal(1, row['tinyint'])
+      assert_equal('template', row['text'])
+    end
+  end
+
+  def test_bind_new_copy_on_write
+    @insert_statement.bind(text: 'before', int: 1)
+    id = Random.rand(2**60)
+    bound = @insert_statement.bind_new(id: id)
+
+    # re-binding either statement must not leak into the other
+    @insert_statement.bind(text: 'after')
+    bound.bind(int: 2)
+    Ilios::Cassandra.session.execute(bound)
+
+    statement = Ilios::Cassandra.session.prepare('SELECT * FROM ilios.test WHERE id = ?;')
+    row = Ilios::Cassandra.session.execute(statement.bind([id])).first
+
+    assert_equal('before', row['text'])
+    assert_equal(2, row['int'])
   end
 
   def test_bind_null
@@ -196,6 +280,39 @@ class StatementTest < Minitest::Test
     results = insert_and_get_results
 
     assert_equal('hello', results.first['text'])
+
+    # embedded NUL is bound as is
+    assert_kind_of(Ilios::Cassandra::Statement, @insert_statement.bind(text: "hel\0lo"))
+
+    results = insert_and_get_results
+
+    assert_equal("hel\0lo", results.first['text'])
+
+    # later mutation of the given string is not bound
+    text = +'hello'
+    @insert_statement.bind(text: text)
+    text << ' world'
+
+    results = insert_and_get_results
+
+    assert_equal('hello', results.first['text'])
+  end
+
+  def test_bind_blob
+    statement = Ilios::Cassandra.session.prepare('INSERT INTO ilios.test (id, blob) VALUES (?, ?);')
+
+    # invalid value
+    assert_raises(TypeError) { statement.bind(blob: Object.new) }
+
+    # valid values
+    bytes = Random.bytes(4096)
+
+    assert_equal(bytes, insert_and_get_blob(statement, bytes))
+    assert_equal(Encoding::BINARY, insert_and_get_blob(statement, bytes).encoding)
+
+    if defined?(IO::Buffer)
+      assert_equal(bytes, insert_and_get_blob(statement, IO::Buffer.for(bytes)))
+    end
   end
 
   def test_bind_timestamp
@@ -282,6 +399,14 @@ class StatementTest < Minitest::Test
 
   private
 
+  def insert_and_get_blob(statement, blob)
+    id = Random.rand(2**60)
+    Ilios::Cassandra.session.execute(statement.bind({ id: id, blob: blob }))
+
+    select_statement = Ilios::Cassandra.session.prepare('SELECT blob FROM ilios.test WHERE id = ?;')
+    Ilios::Cassandra.session.execute(select_statement.bind([id])).first['blob']
+  end
+
   def insert_and_get_results
     id = Random.rand(2**60)
     @insert_statement.bind({ id: id })